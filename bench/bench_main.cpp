@@ -0,0 +1,203 @@
+/**
+ * REGEX STUDIO BENCHMARKS (Google Benchmark)
+ * Every preset template against a log corpus, on each backend with and without the literal
+ * prefilter, plus compile time. bytes_per_second is the MB/s figure the in-app 'bench' prints.
+ * The scan/ benchmarks run the FileScanner over the same corpus split into files on disk:
+ * whole-file views, --stream with small chunks (carry/overlap path) and, with zlib, .gz files.
+ *
+ *   ./bench                                   synthetic 16 MB web-server log
+ *   REGEXSTUDIO_BENCH_CORPUS=access.log ./bench   a real log instead
+ *   ./bench --benchmark_filter=match/ipv4     the usual Google Benchmark flags
+ */
+
+#include "regexstudio_core.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#if defined(REGEX_STUDIO_ZLIB)
+    #include <zlib.h>
+#endif
+
+// ----------------------------------------------------------------------------------
+// Corpus
+// ----------------------------------------------------------------------------------
+
+const size_t CORPUS_BYTES = 16 * 1024 * 1024;
+const int SCAN_FILES = 32;                   // corpus pieces written for the scanner benchmarks
+const size_t SCAN_CHUNK = 64 * 1024;         // --stream chunk, small so every file carries many times
+const size_t SCAN_OVERLAP = 4 * 1024;
+
+// CORPUS: Deterministic access/application log lines. Roughly half the lines carry an email,
+// a quarter a phone number, every line a timestamp and most an IP and a URL, so the templates
+// see realistic match densities instead of a best-case (no literal) or worst-case text.
+std::string SyntheticCorpus(size_t bytes) {
+    static const char* users[] = { "alice", "bob.smith", "carol_w", "dave", "erin.k", "frank99" };
+    static const char* domains[] = { "example.com", "mail.org", "corp.net", "test.io" };
+    static const char* paths[] = { "api/v1/users", "static/app.js", "login", "search", "health" };
+    static const char* levels[] = { "INFO", "INFO", "INFO", "WARN", "DEBUG", "ERROR" };
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&](uint32_t n) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (uint32_t)(state >> 33) % n;
+    };
+
+    std::string out;
+    out.reserve(bytes + 256);
+    char line[512];
+    while (out.size() < bytes) {
+        int len = snprintf(line, sizeof(line), "%04u-%02u-%02uT%02u:%02u:%02uZ %-5s [worker-%u] ",
+                           2020 + next(6), 1 + next(12), 1 + next(28), next(24), next(60), next(60),
+                           levels[next(6)], next(16));
+        if (next(10) < 8) {
+            len += snprintf(line + len, sizeof(line) - len, "%u.%u.%u.%u GET %s://%s/%s %u %ums",
+                            10 + next(240), next(256), next(256), 1 + next(254), next(3) ? "https" : "http",
+                            domains[next(4)], paths[next(5)], next(5) ? 200u : 404u, next(900));
+        } else {
+            len += snprintf(line + len, sizeof(line) - len, "cache flush completed, %u entries evicted", next(100000));
+        }
+        if (next(2)) len += snprintf(line + len, sizeof(line) - len, " user=%s@%s", users[next(6)], domains[next(4)]);
+        if (next(4) == 0) len += snprintf(line + len, sizeof(line) - len, " callback=%03u-%03u-%04u", 200 + next(800), next(1000), next(10000));
+        line[len++] = '\n';
+        out.append(line, len);
+    }
+    return out;
+}
+
+const std::string& Corpus() {
+    static const std::string corpus = [] {
+        if (const char* path = std::getenv("REGEXSTUDIO_BENCH_CORPUS")) {
+            std::ifstream file(path, std::ios::binary);
+            if (file) return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            std::cerr << "[WARN] Cannot read " << path << ", using the synthetic corpus" << std::endl;
+        }
+        return SyntheticCorpus(CORPUS_BYTES);
+    }();
+    return corpus;
+}
+
+// SCAN TREE: The corpus cut at line ends into SCAN_FILES files (plain/ and, with zlib, gz/)
+// under a temporary directory that main() removes again
+std::filesystem::path scanTreeRoot; // set once the tree is written
+
+const std::filesystem::path& ScanTree() {
+    static const std::filesystem::path root = [] {
+        std::string unique = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / ("regexstudio_bench_" + unique);
+        std::filesystem::create_directories(dir / "plain");
+        const std::string& corpus = Corpus();
+        size_t begin = 0;
+        for (int i = 0; i < SCAN_FILES && begin < corpus.size(); i++) {
+            size_t end = (i == SCAN_FILES - 1) ? corpus.size() : corpus.find('\n', corpus.size() * (i + 1) / SCAN_FILES);
+            end = (end == std::string::npos) ? corpus.size() : end + 1;
+            std::string name = "part" + std::to_string(i) + ".log";
+            std::ofstream(dir / "plain" / name, std::ios::binary).write(corpus.data() + begin, (std::streamsize)(end - begin));
+#if defined(REGEX_STUDIO_ZLIB)
+            std::filesystem::create_directories(dir / "gz");
+            if (gzFile gz = gzopen((dir / "gz" / (name + ".gz")).string().c_str(), "wb6")) {
+                gzwrite(gz, corpus.data() + begin, (unsigned)(end - begin));
+                gzclose(gz);
+            }
+#endif
+            begin = end;
+        }
+        scanTreeRoot = dir;
+        return dir;
+    }();
+    return root;
+}
+
+// ----------------------------------------------------------------------------------
+// Benchmarks
+// ----------------------------------------------------------------------------------
+
+void BenchMatch(benchmark::State& state, TemplateType tpl, EngineType type, bool prefilter) {
+    const std::string& corpus = Corpus();
+    std::string pattern = TemplateRegex(tpl), error;
+    std::unique_ptr<RegexEngine> engine = CompileEngine(type, pattern, error);
+    if (!engine) { state.SkipWithError(error.c_str()); return; }
+    LiteralPrefilter filter;
+    if (prefilter) filter.Build(pattern);
+
+    size_t matches = 0;
+    for (auto _ : state) {
+        const char* begin = corpus.data();
+        const char* end = begin + corpus.size();
+        try {
+            matches = prefilter ? filter.Count(*engine, begin, end) : engine->Count(begin, end);
+        } catch (const MatchBudgetExceeded& e) {
+            state.SkipWithError(FormatMatchAbort(e).c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)corpus.size());
+    state.counters["matches"] = (double)matches;
+    state.counters["matches/s"] = benchmark::Counter((double)matches, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BenchCompile(benchmark::State& state, TemplateType tpl, EngineType type) {
+    std::string pattern = TemplateRegex(tpl), error;
+    for (auto _ : state) {
+        std::unique_ptr<RegexEngine> engine = CompileEngine(type, pattern, error);
+        if (!engine) { state.SkipWithError(error.c_str()); return; }
+        benchmark::DoNotOptimize(engine.get());
+    }
+}
+
+// Wall time: the scanner spreads the files over every core
+void BenchScan(benchmark::State& state, TemplateType tpl, const char* subdir, bool stream) {
+    ScanOptions opts;
+    opts.pattern = TemplateRegex(tpl);
+    opts.stream = stream;
+    if (stream) { opts.chunkSize = SCAN_CHUNK; opts.overlap = SCAN_OVERLAP; }
+    std::filesystem::path dir = ScanTree() / subdir;
+
+    uint64_t matches = 0;
+    for (auto _ : state) {
+        FileScanner scanner;
+        std::string error;
+        if (!scanner.Start(dir, opts, error)) { state.SkipWithError(error.c_str()); return; }
+        scanner.Wait();
+        std::vector<ScanHit> hits;
+        scanner.results.Drain(hits);
+        for (const auto& hit : hits) {
+            if (!hit.warning.empty()) { state.SkipWithError((hit.path + ": " + hit.warning).c_str()); return; }
+        }
+        matches = scanner.totalMatches;
+        benchmark::DoNotOptimize(matches);
+    }
+    // Decompressed bytes for the gz tree, so MB/s compares with the plain runs
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)Corpus().size());
+    state.counters["matches"] = (double)matches;
+}
+
+// One benchmark per template x backend (ENGINE_AUTO resolves to dfa for every template)
+void RegisterTemplateBenchmarks() {
+    const EngineType engines[] = { ENGINE_STD, ENGINE_DFA };
+    for (int t = 0; t < TPL_COUNT; t++) {
+        TemplateType tpl = (TemplateType)t;
+        for (EngineType type : engines) {
+            std::string name = std::string(TemplateName(tpl)) + "/" + EngineTypeName(type);
+            benchmark::RegisterBenchmark(("match/" + name).c_str(), BenchMatch, tpl, type, false)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("match/" + name + "+prefilter").c_str(), BenchMatch, tpl, type, true)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("compile/" + name).c_str(), BenchCompile, tpl, type)->Unit(benchmark::kMicrosecond);
+        }
+        std::string scan = std::string("scan/") + TemplateName(tpl);
+        benchmark::RegisterBenchmark((scan + "/view").c_str(), BenchScan, tpl, "plain", false)->Unit(benchmark::kMillisecond)->UseRealTime();
+        benchmark::RegisterBenchmark((scan + "/stream").c_str(), BenchScan, tpl, "plain", true)->Unit(benchmark::kMillisecond)->UseRealTime();
+#if defined(REGEX_STUDIO_ZLIB)
+        benchmark::RegisterBenchmark((scan + "/gzip").c_str(), BenchScan, tpl, "gz", true)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+    }
+}
+
+int main(int argc, char** argv) {
+    RegisterTemplateBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::AddCustomContext("corpus_bytes", std::to_string(Corpus().size()));
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    std::error_code ec;
+    if (!scanTreeRoot.empty()) std::filesystem::remove_all(scanTreeRoot, ec);
+    return 0;
+}
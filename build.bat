@@ -1,4 +1,4 @@
-g++ main.cpp ^
+g++ main.cpp regexstudio_core.cpp ^
  -IC:\raylib\raylib\src ^
  -LC:\raylib\raylib\build\raylib ^
  -lraylib ^
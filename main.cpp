@@ -7,47 +7,120 @@
 
 #include "raylib.h"
 #include "raymath.h" 
-#include <vector>
-#include <string>
-#include <iostream>
-#include <sstream>
-#include <cmath>
-#include <algorithm>
-#include <regex> 
-#include <fstream>
-#include <filesystem>
-#include <map>
-#include <set>
+#include "regexstudio_core.h"
+
+// ----------------------------------------------------------------------------------
+// Profiler
+// ----------------------------------------------------------------------------------
+
+// ALLOCATION COUNTER: The global operator new counts per thread (threadAllocations, in the core
+// library), so the overlay can show how often the render thread allocates per frame.
+// REGEX_STUDIO_NO_ALLOC_COUNTER leaves new/delete alone.
+#if !defined(REGEX_STUDIO_NO_ALLOC_COUNTER)
+// Out of line, so the compiler never pairs the malloc/free inside them with new/delete calls
+#if defined(_MSC_VER)
+    #define REGEX_STUDIO_NOINLINE __declspec(noinline)
+#else
+    #define REGEX_STUDIO_NOINLINE __attribute__((noinline))
+#endif
+REGEX_STUDIO_NOINLINE void* operator new(size_t size) {
+    threadAllocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+REGEX_STUDIO_NOINLINE void operator delete(void* p) noexcept { free(p); }
+REGEX_STUDIO_NOINLINE void operator delete(void* p, size_t) noexcept { free(p); }
+#endif
 
 // ----------------------------------------------------------------------------------
 // Data Structures
 // ----------------------------------------------------------------------------------
 
-enum NodeType {
-    NODE_START, NODE_END,
-    NODE_TEXT, NODE_DIGIT, NODE_WHITESPACE,
-    NODE_ANY, NODE_WORD, NODE_SYMBOL, NODE_CUSTOM,
-    NODE_NOT_DIGIT, NODE_NOT_WHITESPACE, NODE_NOT_WORD,
-    NODE_ZERO_OR_MORE, NODE_ONE_OR_MORE, NODE_OPTIONAL,
-    NODE_GROUP_START, NODE_GROUP_END, NODE_OR
+// STRING POOL: Node titles and values are interned into append-only blocks (render thread only).
+// Equal strings share one entry, so most titles resolve to the fixed AddNode table and a node's
+// text is a 4-byte handle. Entries are never freed, so text being typed stays in the node editor's
+// buffer and is interned once when the edit is committed.
+const size_t STRING_POOL_BLOCK = 64 * 1024;
+
+class StringPool {
+public:
+    StringPool() { entries.push_back(std::string_view("", 0)); index.emplace(entries[0], 0); }
+
+    uint32_t Intern(std::string_view s) {
+        auto it = index.find(s);
+        if (it != index.end()) return it->second;
+        char* mem = Allocate(s.size() + 1);
+        memcpy(mem, s.data(), s.size());
+        mem[s.size()] = '\0'; // c_str() for raylib
+        uint32_t id = (uint32_t)entries.size();
+        entries.emplace_back(mem, s.size());
+        index.emplace(entries.back(), id);
+        return id;
+    }
+    std::string_view View(uint32_t id) const { return entries[id]; }
+    size_t Count() const { return entries.size(); }
+    size_t Bytes() const { return reserved; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* current = nullptr; // block small entries are carved from
+    size_t used = 0, capacity = 0, reserved = 0;
+    std::vector<std::string_view> entries;
+    std::unordered_map<std::string_view, uint32_t> index;
+
+    char* Allocate(size_t n) {
+        if (n > STRING_POOL_BLOCK / 4) {
+            // Oversized values get their own block; the current one keeps filling
+            blocks.emplace_back(new char[n]);
+            reserved += n;
+            return blocks.back().get();
+        }
+        if (!current || used + n > capacity) {
+            blocks.emplace_back(new char[STRING_POOL_BLOCK]);
+            current = blocks.back().get();
+            used = 0;
+            capacity = STRING_POOL_BLOCK;
+            reserved += STRING_POOL_BLOCK;
+        }
+        char* p = current + used;
+        used += n;
+        return p;
+    }
+};
+StringPool nodeStrings;
+
+// Handle to an interned string: copies are plain integers and equality is an id compare
+struct NodeText {
+    uint32_t id = 0;
+
+    NodeText() = default;
+    explicit NodeText(std::string_view s) : id(nodeStrings.Intern(s)) {}
+    NodeText& operator=(std::string_view s) { id = nodeStrings.Intern(s); return *this; }
+
+    std::string_view view() const { return nodeStrings.View(id); }
+    const char* c_str() const { return view().data(); }
+    size_t size() const { return view().size(); }
+    bool empty() const { return id == 0; }
+    std::string str() const { return std::string(view()); }
+    operator std::string() const { return str(); }
+
+    bool operator==(const NodeText& o) const { return id == o.id; }
+    bool operator!=(const NodeText& o) const { return id != o.id; }
+    bool operator==(std::string_view s) const { return view() == s; }
 };
 
 struct Node {
     int id;
     Rectangle rect;
     NodeType type;
-    std::string title;
-    std::string regexValue;
+    NodeText title;
+    NodeText regexValue;
     Color color;
     bool isEditing;
     bool selected; 
     Vector2 dragOffset; 
 };
-
-struct Connection {
-    int fromNodeId;
-    int toNodeId;
-};
+static_assert(std::is_trivially_copyable<Node>::value, "nodes are copied as plain data (undo, clipboard, snapshots)");
 
 // Clipboard Structure 
 struct ClipboardData {
@@ -69,18 +142,101 @@ struct DebugMatch {
     std::vector<DebugGroup> groups;
 };
 
-// UNDO/REDO STATE (Feature 2)
-struct AppState {
-    std::vector<Node> nodes;
-    std::vector<Connection> connections;
-    int nextNodeId;
+// HIGHLIGHT SPANS: Sorted, non-overlapping runs of playground text to tint (1 = match, 2-4 = groups)
+struct HighlightSpan {
+    size_t start;
+    size_t length;
+    int colorId;
+};
+
+// TEXT LAYOUT: Advance widths measured once per (font, size), and the visual line starts of a
+// wrapped text kept until its revision, width or font changes
+struct GlyphAdvanceTable {
+    unsigned int fontId;
+    float fontSize;
+    float advance[256];
+};
+
+struct TextLayout {
+    size_t revision = (size_t)-1;
+    unsigned int fontId = 0;
+    float fontSize = 0;
+    float width = -1;
+    std::vector<size_t> lineStarts; // byte offset where each visual line begins
+    float Height() const { return lineStarts.size() * fontSize; }
+};
+
+// UNDO/REDO HISTORY (Feature 2): An undo point stores only the edits made after it, not the graph
+enum EditKind { EDIT_ADD_NODE, EDIT_REMOVE_NODE, EDIT_ADD_CONNECTION, EDIT_REMOVE_CONNECTION, EDIT_MOVE, EDIT_SET_VALUE };
+
+struct EditOp {
+    EditKind kind;
+    int nodeId = -1;
+    int index = -1;          // vector slot of a removed node/connection
+    Node node{};             // add / remove node
+    Connection conn{};       // add / remove connection
+    Vector2 before{}, after{};                       // move
+    NodeText beforeTitle, beforeValue, afterTitle, afterValue;   // value edit
+};
+
+struct EditTransaction {
+    std::vector<EditOp> ops;
+    size_t bytes = 0;
+};
+
+const size_t UNDO_DEFAULT_DEPTH = 50;
+
+// Ring buffer of transactions: [0, cursor) can be undone, [cursor, size) redone
+class EditHistory {
+public:
+    explicit EditHistory(size_t depth) : ring(depth) {}
+
+    void Push(EditTransaction&& t) {
+        while (size > cursor) totalBytes -= At(--size).bytes; // a new edit drops the redo branch
+        if (size == ring.size()) { totalBytes -= At(0).bytes; At(0) = EditTransaction(); start = (start + 1) % ring.size(); size--; cursor--; }
+        totalBytes += t.bytes;
+        At(size++) = std::move(t);
+        cursor++;
+    }
+    EditTransaction* PopUndo() { return cursor ? &At(--cursor) : nullptr; }
+    EditTransaction* PopRedo() { return cursor < size ? &At(cursor++) : nullptr; }
+
+    void Clear() {
+        for (auto& t : ring) t = EditTransaction();
+        start = size = cursor = 0;
+        totalBytes = 0;
+    }
+
+    // Keeps the newest entries that fit
+    void SetDepth(size_t depth) {
+        if (depth == 0) depth = 1;
+        std::vector<EditTransaction> kept(depth);
+        size_t drop = size > depth ? size - depth : 0;
+        for (size_t i = drop; i < size; i++) kept[i - drop] = std::move(At(i));
+        for (size_t i = 0; i < drop; i++) totalBytes -= At(i).bytes;
+        ring = std::move(kept);
+        start = 0;
+        size -= drop;
+        cursor = cursor > drop ? cursor - drop : 0;
+    }
+
+    size_t Depth() const { return ring.size(); }
+    size_t UndoCount() const { return cursor; }
+    size_t RedoCount() const { return size - cursor; }
+    size_t Bytes() const { return totalBytes + ring.capacity() * sizeof(EditTransaction); }
+
+private:
+    std::vector<EditTransaction> ring;
+    size_t start = 0, size = 0, cursor = 0;
+    size_t totalBytes = 0;
+
+    EditTransaction& At(size_t i) { return ring[(start + i) % ring.size()]; }
 };
 
 // EXPORT LANGUAGES (Feature 1)
-enum ExportLang { LANG_RAW, LANG_CPP, LANG_PYTHON, LANG_JS, LANG_CSHARP, LANG_JAVA };
+enum ExportLang { LANG_RAW, LANG_CPP, LANG_PYTHON, LANG_JS, LANG_CSHARP, LANG_JAVA, LANG_CPP_NATIVE };
 
 // TEMPLATES (New Feature)
-enum TemplateType { TPL_EMAIL, TPL_DATE_ISO, TPL_PHONE_US, TPL_URL_SIMPLE, TPL_IP_V4 };
 
 // ----------------------------------------------------------------------------------
 // Global Variables
@@ -89,9 +245,128 @@ std::vector<Node> nodes;
 std::vector<Connection> connections;
 int nextNodeId = 0;
 
-// Undo/Redo Stacks
-std::vector<AppState> undoStack;
-std::vector<AppState> redoStack;
+// GRAPH INDEX (Maintained by AddNode / AddConnection, rebuilt after deletes, undo and load)
+struct GraphIndex {
+    std::unordered_map<int, int> slot;     // node id -> index in nodes
+    std::unordered_map<int, int> next;     // node id -> target of its first outgoing connection
+    std::unordered_map<int, int> incoming; // node id -> number of incoming connections
+    std::unordered_map<int, int> outgoing; // node id -> number of outgoing connections
+    int revision = 0;                      // bumped on every structural change
+};
+GraphIndex graphIndex;
+
+// SPATIAL GRID: Uniform buckets of node slots over world space, so hit tests, box select and
+// drawing only visit nearby nodes. Rebuilt lazily after structural changes (slots shift with the
+// graph index); moves update only the buckets a node enters or leaves.
+const float GRID_CELL = 256.0f;
+
+class SpatialGrid {
+public:
+    int revision = -1; // graphIndex.revision it was built for
+
+    void Rebuild(const std::vector<Node>& all, int rev) {
+        cells.clear();
+        spans.resize(all.size());
+        for (size_t i = 0; i < all.size(); i++) {
+            spans[i] = SpanOf(all[i].rect);
+            Insert((int)i, spans[i]);
+        }
+        revision = rev;
+    }
+
+    void Move(int slot, const Rectangle& rect) {
+        if (slot < 0 || (size_t)slot >= spans.size()) return;
+        Span s = SpanOf(rect);
+        if (s == spans[slot]) return;
+        Erase(slot, spans[slot]);
+        Insert(slot, s);
+        spans[slot] = s;
+    }
+
+    // Slots whose bucket overlaps 'area', ascending (draw order) and without duplicates;
+    // callers still test the exact rectangle
+    void Query(const Rectangle& area, std::vector<int>& out) const {
+        out.clear();
+        Span s = SpanOf(area);
+        if ((uint64_t)(s.x1 - s.x0 + 1) * (s.y1 - s.y0 + 1) > cells.size()) {
+            // Zoomed far out: walking the populated buckets is cheaper than the empty area
+            for (const auto& c : cells) {
+                int cx = (int)(int32_t)(c.first >> 32), cy = (int)(int32_t)(uint32_t)c.first;
+                if (cx >= s.x0 && cx <= s.x1 && cy >= s.y0 && cy <= s.y1) out.insert(out.end(), c.second.begin(), c.second.end());
+            }
+        } else {
+            for (int y = s.y0; y <= s.y1; y++) for (int x = s.x0; x <= s.x1; x++) {
+                auto it = cells.find(Key(x, y));
+                if (it != cells.end()) out.insert(out.end(), it->second.begin(), it->second.end());
+            }
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+
+private:
+    struct Span {
+        int x0, y0, x1, y1;
+        bool operator==(const Span& o) const { return x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1; }
+    };
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    std::vector<Span> spans; // per slot, the buckets it is listed in
+
+    static uint64_t Key(int x, int y) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y; }
+    static Span SpanOf(const Rectangle& r) {
+        return { (int)std::floor(r.x / GRID_CELL), (int)std::floor(r.y / GRID_CELL),
+                 (int)std::floor((r.x + r.width) / GRID_CELL), (int)std::floor((r.y + r.height) / GRID_CELL) };
+    }
+    void Insert(int slot, const Span& s) {
+        for (int y = s.y0; y <= s.y1; y++) for (int x = s.x0; x <= s.x1; x++) cells[Key(x, y)].push_back(slot);
+    }
+    void Erase(int slot, const Span& s) {
+        for (int y = s.y0; y <= s.y1; y++) for (int x = s.x0; x <= s.x1; x++) {
+            auto it = cells.find(Key(x, y));
+            if (it == cells.end()) continue;
+            auto& v = it->second;
+            v.erase(std::remove(v.begin(), v.end(), slot), v.end());
+            if (v.empty()) cells.erase(it);
+        }
+    }
+};
+SpatialGrid spatialGrid;
+
+// WIRE CACHE: Triangle strip of each connection's bezier (the same curve DrawLineBezier draws),
+// re-tessellated only when an endpoint moves. Parallel to 'connections'; reset on structural changes.
+const int WIRE_SEGMENTS = 24;
+
+struct WireMesh {
+    Vector2 start = { NAN, NAN }, end = { NAN, NAN };
+    Vector2 strip[2 * WIRE_SEGMENTS + 2];
+};
+
+struct WireCache {
+    int revision = -1;
+    std::vector<WireMesh> meshes;
+};
+WireCache wireCache;
+
+// Per-frame canvas counts for the profiler overlay
+struct CanvasStats {
+    size_t nodesDrawn = 0, wiresDrawn = 0, wiresTessellated = 0;
+};
+CanvasStats canvasStats;
+
+// GENERATED REGEX CACHE (Chain of node ids and where each fragment sits in 'text')
+struct RegexChainCache {
+    int structureRev = -1;
+    std::vector<int> chain;
+    std::vector<size_t> offsets;
+    std::unordered_map<int, size_t> position; // node id -> index in chain
+    std::string text;
+};
+RegexChainCache regexChain;
+
+// Undo/Redo History (the open transaction collects edits until the next undo point)
+EditHistory editHistory(UNDO_DEFAULT_DEPTH);
+EditTransaction pendingEdit;
+bool editOpen = false;
 
 // Interaction State
 bool isCreatingConnection = false;
@@ -109,12 +384,19 @@ Font mainFont = { 0 };
 bool showConsole = false;
 bool showPlayground = false;
 bool showHelp = false;
+bool showProfiler = false; // F3
 bool showFullRegex = false; 
 bool showTemplates = false; // NEW: Templates Window
 bool isDebugging = false; 
 
 // Export State
 ExportLang currentExportLang = LANG_RAW;
+// NATIVE EXPORT CACHE (The generated header only changes with the pattern)
+struct NativeExportCache {
+    std::string pattern;
+    std::string code;
+    bool valid = false;
+} nativeExport;
 // Full View Scroll State
 float fullRegexScroll = 0.0f;
 bool isDraggingFullRegexScroll = false;
@@ -125,16 +407,90 @@ std::vector<std::string> consoleLog;
 int consoleScrollIndex = 0;
 bool isDraggingScrollbar = false;
 
+// HEADLESS MODE (Command line batch run: no window, AddLog goes to stderr)
+bool headlessMode = false;
+
+// SCAN JOB (Runs in the background, drained into consoleLog every frame)
+std::unique_ptr<FileScanner> activeScan;
+
+// BENCH JOB (Same lifecycle as the scan job; results are logged and exported when it finishes)
+std::unique_ptr<BenchJob> activeBench;
+std::string benchPattern;
+std::string benchCsvPath;
+std::string benchJsonPath;
+
 // PLAYGROUND & DEBUGGER DATA
-std::string playgroundText = "Hello World! Contact: test@email.com. Date: 2023-10-27.";
+PieceTable playgroundText("Hello World! Contact: test@email.com. Date: 2023-10-27.");
 Rectangle playgroundRect = { 0, 0, 0, 0 };
 float playgroundScrollOffset = 0.0f;
+float playgroundViewHeight = 0.0f; // text area height of the last frame
 bool isDraggingPlaygroundScroll = false;
 
+std::deque<GlyphAdvanceTable> glyphTables; // deque: handed-out tables never move
+TextLayout playgroundLayout;
+TextLayout codeViewLayout;
+
+// Whole-document match count (restarted from a checkpoint after each edit)
+DocumentMatchCounter playgroundCounter;
+struct PlaygroundCountState {
+    int graphRev = -1;
+    int textRev = -1;
+    EngineType engine = ENGINE_AUTO;
+    uint64_t serial = 0;
+    bool active = false;
+} playgroundCount;
+const size_t PLAYGROUND_MATCH_MARGIN = 16 * 1024; // bytes matched around the viewport
+
 // Debugger State
-std::vector<DebugMatch> currentDebugMatches;
+std::vector<DebugMatch> currentDebugMatches; // analysed prefix of the match table (drives the highlighter too)
 int currentDebugMatchIndex = 0;
 
+// DEBUG ANALYSIS: Large inputs are analysed lazily, DEBUG_BATCH matches at a time while stepping
+struct DebugAnalysis {
+    int graphRev = -1;
+    int textRev = -1;
+    size_t resume = 0;        // offset where the next batch continues
+    long lastEmptyAt = -1;    // an empty match here was already recorded
+    bool complete = true;
+    const char* text = nullptr;
+    std::string scratch;      // contiguous copy when the playground spans several pieces
+    std::string warning;      // set when the match budget stopped the analysis
+};
+DebugAnalysis debugAnalysis;
+const size_t DEBUG_BATCH = 256;
+const size_t DEBUG_LAZY_THRESHOLD = 1 << 20; // smaller inputs are analysed in one go
+
+// PATTERN CACHE (Revision counters: bump on every edit that can change the output)
+int graphRevision = 0;      // nodes / connections / node values
+int playgroundRevision = 0; // playgroundText
+int debugRevision = 0;      // debugger mode, match table or selected match
+
+// Regex backend used by the playground, debugger and scanner (console: engine std|dfa|auto)
+EngineType currentEngine = ENGINE_AUTO;
+
+struct PatternCache {
+    int graphRev = -1;
+    std::string regexStr;
+    bool compiled = false;
+    std::unique_ptr<RegexEngine> engine;
+    std::string compileError;
+
+    // Highlight spans for the playground, kept between frames
+    int matchGraphRev = -1;
+    int matchTextRev = -1;
+    int matchDebugRev = -1;
+    size_t matchWindowStart = 0; // highlights cover [matchWindowStart, matchWindowEnd) of the text
+    size_t matchWindowEnd = 0;
+    std::vector<HighlightSpan> spans;
+    std::string windowScratch;
+    std::string matchWarning; // set when the match budget aborted the window
+
+    // Static complexity of regexStr and the nodes whose fragments it blames
+    PatternRisk risk;
+    std::unordered_map<int, RiskLevel> riskNodes;
+};
+PatternCache patternCache;
+
 // INPUT TIMING
 float cursorBlinkTimer = 0.0f;
 float keyRepeatTimer = 0.0f;
@@ -148,6 +504,8 @@ const Color COL_WIRE = { 200, 200, 200, 150 };
 const Color COL_WIRE_ACTIVE = { 255, 255, 0, 255 };  
 const Color COL_SELECTION_BOX = { 0, 228, 48, 50 }; 
 const Color COL_SELECTION_BORDER = { 0, 228, 48, 200 };
+const Color COL_RISK_POLY = { 255, 161, 0, 255 };
+const Color COL_RISK_EXP = { 255, 40, 40, 255 };
 
 // Node Colors
 const Color COL_CAT_ANCHOR = { 255, 100, 100, 255 }; 
@@ -173,6 +531,16 @@ bool GuiButton(Rectangle bounds, const char* text, Color borderColor = BLACK);
 void AddLog(std::string msg);
 void AddNode(NodeType type, float x, float y); // Forward declare
 void SaveState(); // Forward declare
+void RecordEdit(EditOp op); // Forward declare
+void ClearEditHistory(); // Forward declare
+void CloseEditTransaction(); // Forward declare
+std::string FormatHistoryStats(); // Forward declare
+void AddConnection(int fromId, int toId); // Forward declare
+void UpdateRegexSegment(int nodeId); // Forward declare
+void UpdateRegexSegment(int nodeId, std::string_view value); // Forward declare
+void RebuildGraphIndex(); // Forward declare
+const std::string& GetCurrentRegex(); // Forward declare
+void AnalyzeMatchesForDebug(); // Forward declare
 
 // TEMPLATE GENERATOR
 void AddTemplate(TemplateType type, float startX, float startY) {
@@ -190,239 +558,473 @@ void AddTemplate(TemplateType type, float startX, float startY) {
         // If Custom Node, set the value immediately
         if (t == NODE_CUSTOM && !customVal.empty()) {
             n.regexValue = customVal;
-            n.title = customVal; // Show value on node
+            n.title = n.regexValue; // Show value on node
+            UpdateRegexSegment(n.id);
         }
 
-        if (prevNodeId != -1) {
-            connections.push_back({prevNodeId, n.id});
-        }
+        if (prevNodeId != -1) AddConnection(prevNodeId, n.id);
         prevNodeId = n.id;
         currentX += spacingX;
     };
 
-    switch (type) {
-        case TPL_EMAIL: // \w+@\w+\.\w+
-            Append(NODE_WORD);
-            Append(NODE_ONE_OR_MORE);
-            Append(NODE_SYMBOL); // @
-            Append(NODE_WORD);
-            Append(NODE_ONE_OR_MORE);
-            Append(NODE_CUSTOM, "."); // literal dot
-            Append(NODE_WORD);
-            Append(NODE_ONE_OR_MORE);
-            break;
-            
-        case TPL_DATE_ISO: // \d{4}-\d{2}-\d{2}
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{4}");
-            Append(NODE_CUSTOM, "-");
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{2}");
-            Append(NODE_CUSTOM, "-");
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{2}");
-            break;
-            
-        case TPL_PHONE_US: // \d{3}-\d{3}-\d{4}
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{3}");
-            Append(NODE_CUSTOM, "-");
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{3}");
-            Append(NODE_CUSTOM, "-");
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{4}");
-            break;
-
-        case TPL_URL_SIMPLE: // https?://\w+\.\w+
-            Append(NODE_CUSTOM, "http");
-            Append(NODE_CUSTOM, "s");
-            Append(NODE_OPTIONAL);
-            Append(NODE_CUSTOM, "://");
-            Append(NODE_WORD);
-            Append(NODE_ONE_OR_MORE);
-            Append(NODE_CUSTOM, ".");
-            Append(NODE_WORD);
-            Append(NODE_ONE_OR_MORE);
-            break;
-
-        case TPL_IP_V4: // \d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3}
-            for(int i=0; i<3; i++) {
-                Append(NODE_DIGIT);
-                Append(NODE_CUSTOM, "{1,3}");
-                Append(NODE_CUSTOM, ".");
-            }
-            Append(NODE_DIGIT);
-            Append(NODE_CUSTOM, "{1,3}");
-            break;
-    }
+    for (const auto& step : TemplateSteps(type)) Append(step.type, step.value);
     
     AddLog("[TEMPLATE] Added preset pattern.");
     showTemplates = false;
 }
 
+// PROJECT FILES: VREGEX_2 (core codec, see regexstudio_core.h) by default; VREGEX_1.0 is the
+// original text format, still read and written by 'save --text'.
+std::string EncodeProjectBinary() {
+    std::vector<ProjectNode> records;
+    records.reserve(nodes.size());
+    for (const auto& n : nodes) {
+        records.push_back({ n.id, n.type, n.rect.x, n.rect.y, { n.color.r, n.color.g, n.color.b, n.color.a }, n.title.view(), n.regexValue.view() });
+    }
+    return EncodeProjectBinary(records, connections, nextNodeId);
+}
+
+bool DecodeProjectBinary(const char* data, size_t size, std::vector<Node>& outNodes, std::vector<Connection>& outConns, int& outNextId, std::string& error) {
+    std::vector<ProjectNode> records;
+    if (!DecodeProjectBinary(data, size, records, outConns, outNextId, error)) return false;
+    outNodes.clear();
+    outNodes.reserve(records.size());
+    for (const auto& r : records) {
+        Node n;
+        n.id = r.id;
+        n.type = r.type;
+        n.rect = { r.x, r.y, 160, 60 };
+        n.color = { r.rgba[0], r.rgba[1], r.rgba[2], r.rgba[3] };
+        n.title = r.title; // interned straight from the file buffer
+        n.regexValue = r.regexValue;
+        n.isEditing = false;
+        n.selected = false;
+        outNodes.push_back(n);
+    }
+    return true;
+}
+
 // Helper to write string with length prefix to avoid space issues
-void WriteString(std::ofstream& file, const std::string& s) {
+void WriteString(std::ofstream& file, std::string_view s) {
     size_t len = s.length();
     file << len << " " << s << " ";
 }
 
-// Helper to read string with length prefix
-std::string ReadString(std::ifstream& file) {
+// Helper to read string with length prefix (the length may not exceed what is left of the file)
+bool ReadString(std::istream& file, size_t remaining, std::string& s) {
     size_t len;
-    file >> len;
+    if (!(file >> len) || len > remaining) return false;
     char temp; 
     file.get(temp); 
-    std::string s(len, '\0');
+    s.assign(len, '\0');
     file.read(&s[0], len);
-    return s;
+    return (size_t)file.gcount() == len;
 }
 
-void SaveProject(const std::string& filename) {
-    std::string path = filename;
-    if (path.find(".vreg") == std::string::npos) path += ".vreg";
-
-    std::ofstream file(path);
-    if (!file.is_open()) {
-        AddLog("[ERROR] Could not create file: " + path);
-        return;
-    }
-
-    file << "VREGEX_1.0" << std::endl;
-    file << nodes.size() << std::endl;
-    for (const auto& n : nodes) {
-        file << n.id << " " << (int)n.type << " " 
-             << n.rect.x << " " << n.rect.y << " " 
-             << (int)n.color.r << " " << (int)n.color.g << " " << (int)n.color.b << " " << (int)n.color.a << " ";
-        WriteString(file, n.title);
-        WriteString(file, n.regexValue);
-        file << std::endl;
-    }
-    file << connections.size() << std::endl;
-    for (const auto& c : connections) {
-        file << c.fromNodeId << " " << c.toNodeId << std::endl;
-    }
-    file << nextNodeId << std::endl;
-    file.close();
-    AddLog("[SUCCESS] Project saved to: " + std::filesystem::absolute(path).string());
+bool ReadString(std::istream& file, size_t remaining, NodeText& s) {
+    std::string value;
+    if (!ReadString(file, remaining, value)) return false;
+    s = value;
+    return true;
 }
 
-void LoadProject(const std::string& filename) {
-    std::string path = filename;
-    if (path.find(".vreg") == std::string::npos) path += ".vreg";
-
-    if (!std::filesystem::exists(path)) {
-        AddLog("[ERROR] File not found: " + path);
-        return;
-    }
-
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        AddLog("[ERROR] Could not open file.");
-        return;
-    }
-
+bool DecodeProjectText(const char* data, size_t size, std::vector<Node>& outNodes, std::vector<Connection>& outConns, int& outNextId, std::string& error) {
+    std::istringstream file(std::string(data, size));
     std::string header;
     file >> header;
-    if (header != "VREGEX_1.0") {
-        AddLog("[ERROR] Invalid file format.");
-        return;
-    }
-
-    nodes.clear();
-    connections.clear();
-
     size_t nodeCount;
-    file >> nodeCount;
+    if (!(file >> nodeCount) || nodeCount > size) { error = "bad node count"; return false; }
+    outNodes.clear();
     for (size_t i = 0; i < nodeCount; ++i) {
         Node n;
         int typeInt, r, g, b, a;
         file >> n.id >> typeInt >> n.rect.x >> n.rect.y >> r >> g >> b >> a;
+        if (!file || typeInt < 0 || typeInt > NODE_OR) { error = "bad node record " + std::to_string(i); return false; }
         n.type = (NodeType)typeInt;
         n.color = { (unsigned char)r, (unsigned char)g, (unsigned char)b, (unsigned char)a };
-        n.title = ReadString(file);
-        n.regexValue = ReadString(file);
+        if (!ReadString(file, size, n.title) || !ReadString(file, size, n.regexValue)) { error = "bad string in node " + std::to_string(i); return false; }
         
         n.rect.width = 160; 
         n.rect.height = 60;
         n.isEditing = false;
         n.selected = false;
         
-        nodes.push_back(n);
+        outNodes.push_back(n);
     }
 
     size_t connCount;
-    file >> connCount;
+    if (!(file >> connCount) || connCount > size) { error = "bad connection count"; return false; }
+    outConns.clear();
     for (size_t i = 0; i < connCount; ++i) {
         Connection c;
-        file >> c.fromNodeId >> c.toNodeId;
-        connections.push_back(c);
+        if (!(file >> c.fromNodeId >> c.toNodeId)) { error = "bad connection " + std::to_string(i); return false; }
+        outConns.push_back(c);
+    }
+
+    if (!(file >> outNextId)) { error = "missing node id counter"; return false; }
+    return true;
+}
+
+void SaveProject(const std::string& filename, bool textFormat = false) {
+    std::string path = filename;
+    if (path.find(".vreg") == std::string::npos) path += ".vreg";
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        AddLog("[ERROR] Could not create file: " + path);
+        return;
     }
 
-    file >> nextNodeId;
+    if (textFormat) {
+        file << "VREGEX_1.0" << std::endl;
+        file << nodes.size() << std::endl;
+        for (const auto& n : nodes) {
+            file << n.id << " " << (int)n.type << " " 
+                 << n.rect.x << " " << n.rect.y << " " 
+                 << (int)n.color.r << " " << (int)n.color.g << " " << (int)n.color.b << " " << (int)n.color.a << " ";
+            WriteString(file, n.title.view());
+            WriteString(file, n.regexValue.view());
+            file << std::endl;
+        }
+        file << connections.size() << std::endl;
+        for (const auto& c : connections) {
+            file << c.fromNodeId << " " << c.toNodeId << std::endl;
+        }
+        file << nextNodeId << std::endl;
+    } else {
+        std::string bytes = EncodeProjectBinary();
+        file.write(bytes.data(), (std::streamsize)bytes.size());
+    }
     file.close();
+    if (!file) { AddLog("[ERROR] Could not write file: " + path); return; }
+    AddLog("[SUCCESS] Project saved to: " + std::filesystem::absolute(path).string() + (textFormat ? " (text)" : ""));
+}
+
+// Decodes either format into the given vectors without touching the canvas
+bool ReadProjectFile(const std::string& path, std::vector<Node>& outNodes, std::vector<Connection>& outConns, int& outNextId, std::string& error) {
+    if (!std::filesystem::exists(path)) { error = "File not found: " + path; return false; }
+    FileView view;
+    std::vector<char> buffer;
+    if (!view.Open(path, buffer)) { error = "Could not open file: " + path; return false; }
+    const char* data = view.Data();
+    size_t size = view.Size();
+    bool ok;
+    if (size >= sizeof(VREGEX_MAGIC) && memcmp(data, VREGEX_MAGIC, sizeof(VREGEX_MAGIC)) == 0) {
+        ok = DecodeProjectBinary(data, size, outNodes, outConns, outNextId, error);
+    } else if (size >= 10 && memcmp(data, "VREGEX_1.0", 10) == 0) {
+        ok = DecodeProjectText(data, size, outNodes, outConns, outNextId, error);
+    } else {
+        error = "Invalid file format: " + path;
+        return false;
+    }
+    if (!ok) error = "Corrupt project file (" + error + "): " + path;
+    return ok;
+}
+
+std::string ProjectPath(const std::string& filename) {
+    return filename.find(".vreg") == std::string::npos ? filename + ".vreg" : filename;
+}
+
+// Parses into scratch vectors first, so a damaged file leaves the current graph untouched
+bool LoadProject(const std::string& filename) {
+    std::string path = ProjectPath(filename);
+    std::vector<Node> loadedNodes;
+    std::vector<Connection> loadedConns;
+    int loadedNextId = 0;
+    std::string error;
+    if (!ReadProjectFile(path, loadedNodes, loadedConns, loadedNextId, error)) {
+        AddLog("[ERROR] " + error);
+        return false;
+    }
+
+    nodes = std::move(loadedNodes);
+    connections = std::move(loadedConns);
+    nextNodeId = loadedNextId;
+    for (const auto& n : nodes) nextNodeId = std::max(nextNodeId, n.id + 1);
+    RebuildGraphIndex();
+    ClearEditHistory(); // recorded edits refer to the previous graph
     AddLog("[SUCCESS] Project Loaded.");
+    return true;
 }
 
-void AddNode(NodeType type, float x, float y) {
+// A node of 'type' with its palette defaults; the caller assigns the id
+Node MakeNode(NodeType type, float x, float y) {
     Node n;
-    n.id = nextNodeId++;
+    n.id = -1;
     n.rect = { x, y, 160, 60 };
     n.type = type;
     n.isEditing = false;
     n.selected = false;
 
+    NodeDefaults defaults = DefaultNode(type);
+    n.title = defaults.title;
+    n.regexValue = defaults.regexValue;
     switch (type) {
-        case NODE_CUSTOM: n.title = "Custom Text"; n.regexValue = "abc"; n.color = COL_CAT_CUSTOM; break;
-        case NODE_START: n.title = "Start of Line"; n.regexValue = "^"; n.color = COL_CAT_ANCHOR; break;
-        case NODE_END: n.title = "End of Line"; n.regexValue = "$"; n.color = COL_CAT_ANCHOR; break;
-        case NODE_TEXT: n.title = "Letters"; n.regexValue = "[a-zA-Z]+"; n.color = COL_CAT_CHAR; break;
-        case NODE_DIGIT: n.title = "Numbers"; n.regexValue = "\\d"; n.color = COL_CAT_DIGIT; break;
-        case NODE_WHITESPACE: n.title = "Whitespace"; n.regexValue = "\\s"; n.color = COL_CAT_SPECIAL; break;
-        case NODE_ANY: n.title = "Any Char"; n.regexValue = "."; n.color = COL_CAT_SPECIAL; break;
-        case NODE_WORD: n.title = "Word Chars"; n.regexValue = "\\w"; n.color = COL_CAT_CHAR; break;
-        case NODE_SYMBOL: n.title = "Symbol @"; n.regexValue = "@"; n.color = PURPLE; break;
-        case NODE_NOT_DIGIT: n.title = "Non-Number"; n.regexValue = "\\D"; n.color = COL_CAT_NEGATED; break;
-        case NODE_NOT_WHITESPACE: n.title = "Non-Space"; n.regexValue = "\\S"; n.color = COL_CAT_NEGATED; break;
-        case NODE_NOT_WORD: n.title = "Non-Word"; n.regexValue = "\\W"; n.color = COL_CAT_NEGATED; break;
-        case NODE_ZERO_OR_MORE: n.title = "Repeat (0+)"; n.regexValue = "*"; n.color = COL_CAT_QUANT; break;
-        case NODE_ONE_OR_MORE: n.title = "Repeat (1+)"; n.regexValue = "+"; n.color = COL_CAT_QUANT; break;
-        case NODE_OPTIONAL: n.title = "Optional"; n.regexValue = "?"; n.color = COL_CAT_QUANT; break;
-        case NODE_GROUP_START: n.title = "Start Group"; n.regexValue = "("; n.color = COL_CAT_STRUCT; break;
-        case NODE_GROUP_END: n.title = "End Group"; n.regexValue = ")"; n.color = COL_CAT_STRUCT; break;
-        case NODE_OR: n.title = "OR (Either)"; n.regexValue = "|"; n.color = COL_CAT_STRUCT; break;
+        case NODE_START: case NODE_END: n.color = COL_CAT_ANCHOR; break;
+        case NODE_TEXT: case NODE_WORD: n.color = COL_CAT_CHAR; break;
+        case NODE_DIGIT: n.color = COL_CAT_DIGIT; break;
+        case NODE_WHITESPACE: case NODE_ANY: n.color = COL_CAT_SPECIAL; break;
+        case NODE_SYMBOL: n.color = PURPLE; break;
+        case NODE_CUSTOM: n.color = COL_CAT_CUSTOM; break;
+        case NODE_NOT_DIGIT: case NODE_NOT_WHITESPACE: case NODE_NOT_WORD: n.color = COL_CAT_NEGATED; break;
+        case NODE_ZERO_OR_MORE: case NODE_ONE_OR_MORE: case NODE_OPTIONAL: n.color = COL_CAT_QUANT; break;
+        case NODE_GROUP_START: case NODE_GROUP_END: case NODE_OR: n.color = COL_CAT_STRUCT; break;
     }
+    return n;
+}
+
+void AddNode(NodeType type, float x, float y) {
+    Node n = MakeNode(type, x, y);
+    n.id = nextNodeId++;
     nodes.push_back(n);
+    graphIndex.slot[n.id] = (int)nodes.size() - 1;
+    graphIndex.revision++;
+    graphRevision++;
+    EditOp op; op.kind = EDIT_ADD_NODE; op.nodeId = n.id;
+    RecordEdit(op);
+}
+
+// REGEX IMPORT: The tokens (TokenizeRegex) are appended in bulk as one chain whose generated
+// regex is the input again, with one undo step for the whole import.
+const int IMPORT_ROW_NODES = 16;      // a layer wraps after this many nodes
+const float IMPORT_INDENT = 40.0f;    // per group level
+const float IMPORT_ROW_HEIGHT = 90.0f;
+const size_t IMPORT_TITLE_MAX = 14;
+
+// Layered layout: every alternative ('|' ends a layer) gets its own row, long runs wrap, and rows
+// are indented by group depth. Nodes are appended in one go and the index is rebuilt once.
+bool ImportRegex(const std::string& re, Vector2 origin, std::string& error) {
+    std::vector<ImportToken> tokens;
+    if (!TokenizeRegex(re, tokens, error)) return false;
+    if (tokens.empty()) { error = "empty pattern"; return false; }
+
+    SaveState(); // UNDO POINT: the whole import is one step
+    for (auto& n : nodes) n.selected = false;
+    size_t firstNode = nodes.size(), firstConn = connections.size();
+    nodes.reserve(firstNode + tokens.size());
+    connections.reserve(firstConn + tokens.size() - 1);
+    int col = 0, row = 0;
+    for (size_t t = 0; t < tokens.size(); t++) {
+        const ImportToken& tok = tokens[t];
+        Node n = MakeNode(tok.type, origin.x + tok.depth * IMPORT_INDENT + col * 180.0f, origin.y + row * IMPORT_ROW_HEIGHT);
+        n.id = nextNodeId++;
+        n.selected = true;
+        if (tok.type == NODE_CUSTOM) {
+            n.regexValue = ImportedFragment(tok, re);
+            if (tok.len > IMPORT_TITLE_MAX) n.title = re.substr(tok.begin, IMPORT_TITLE_MAX - 2) + "..";
+            else n.title = n.regexValue;
+        }
+        if (t > 0) connections.push_back({ nodes.back().id, n.id });
+        nodes.push_back(std::move(n));
+        if (tok.type == NODE_OR || ++col == IMPORT_ROW_NODES) { col = 0; row++; }
+    }
+    RebuildGraphIndex();
+    for (size_t i = firstNode; i < nodes.size(); i++) {
+        EditOp op; op.kind = EDIT_ADD_NODE; op.nodeId = nodes[i].id;
+        RecordEdit(std::move(op));
+    }
+    for (size_t i = firstConn; i < connections.size(); i++) {
+        EditOp op; op.kind = EDIT_ADD_CONNECTION; op.conn = connections[i];
+        RecordEdit(std::move(op));
+    }
+    return true;
+}
+
+void LinkConnection(int fromId, int toId) {
+    connections.push_back({fromId, toId});
+    if (!graphIndex.next.count(fromId)) graphIndex.next[fromId] = toId; // the first edge wins, as before
+    graphIndex.incoming[toId]++;
+    graphIndex.outgoing[fromId]++;
+    graphIndex.revision++;
+    graphRevision++;
+}
+
+void AddConnection(int fromId, int toId) {
+    LinkConnection(fromId, toId);
+    EditOp op; op.kind = EDIT_ADD_CONNECTION; op.conn = {fromId, toId};
+    RecordEdit(op);
+}
+
+// Full rebuild for edits that replace or compact the vectors (delete, undo/redo, load)
+void RebuildGraphIndex() {
+    graphIndex.slot.clear();
+    graphIndex.next.clear();
+    graphIndex.incoming.clear();
+    graphIndex.outgoing.clear();
+    for (size_t i = 0; i < nodes.size(); i++) graphIndex.slot[nodes[i].id] = (int)i;
+    for (const auto& c : connections) {
+        if (!graphIndex.next.count(c.fromNodeId)) graphIndex.next[c.fromNodeId] = c.toNodeId;
+        graphIndex.incoming[c.toNodeId]++;
+        graphIndex.outgoing[c.fromNodeId]++;
+    }
+    graphIndex.revision++;
+    graphRevision++;
+}
+
+// O(1) id lookup; the pointer is only valid until the next insert or delete
+Node* FindNode(int id) {
+    auto it = graphIndex.slot.find(id);
+    return it == graphIndex.slot.end() ? nullptr : &nodes[it->second];
+}
+
+void SyncSpatialGrid() {
+    if (spatialGrid.revision != graphIndex.revision) spatialGrid.Rebuild(nodes, graphIndex.revision);
+}
+
+// Called after a node's rect moved; a grid that is already stale is rebuilt on the next query
+void NodeMoved(const Node& n) {
+    if (spatialGrid.revision == graphIndex.revision) spatialGrid.Move((int)(&n - nodes.data()), n.rect);
+}
+
+// Topmost node (last drawn) under a world position, or nullptr
+Node* NodeAt(Vector2 world) {
+    static std::vector<int> candidates;
+    SyncSpatialGrid();
+    spatialGrid.Query({ world.x, world.y, 0, 0 }, candidates);
+    for (size_t k = candidates.size(); k-- > 0;) {
+        if (CheckCollisionPointRec(world, nodes[candidates[k]].rect)) return &nodes[candidates[k]];
+    }
+    return nullptr;
+}
+
+// Value edits only splice the node's own fragment into the cached string
+void UpdateRegexSegment(int nodeId) {
+    const Node* n = FindNode(nodeId);
+    if (n) UpdateRegexSegment(nodeId, n->regexValue.view());
+}
+
+// Same, with 'value' standing in for the node's fragment (an edit that is not committed yet)
+void UpdateRegexSegment(int nodeId, std::string_view value) {
+    graphRevision++;
+    if (regexChain.structureRev != graphIndex.revision) return; // full rebuild pending anyway
+    auto it = regexChain.position.find(nodeId);
+    if (it == regexChain.position.end()) return;
+    size_t k = it->second;
+    size_t begin = regexChain.offsets[k];
+    size_t end = (k + 1 < regexChain.offsets.size()) ? regexChain.offsets[k + 1] : regexChain.text.size();
+    regexChain.text.replace(begin, end - begin, value);
+    long delta = (long)value.size() - (long)(end - begin);
+    for (size_t j = k + 1; j < regexChain.offsets.size(); j++) regexChain.offsets[j] += delta;
 }
 
 std::string GenerateRegex() {
-    std::stringstream ss;
+    if (regexChain.structureRev == graphIndex.revision) return regexChain.text;
+    ProfileScope scope(PROF_GRAPH);
+    regexChain.structureRev = graphIndex.revision;
+    regexChain.chain.clear();
+    regexChain.offsets.clear();
+    regexChain.position.clear();
+    regexChain.text.clear();
+
     int currentNodeId = -1;
     for (const auto& node : nodes) {
-        if (node.type == NODE_START) { currentNodeId = node.id; ss << node.regexValue; break; }
-    }
-    if (currentNodeId == -1 && !nodes.empty()) {
-         for (const auto& n : nodes) {
-             bool hasInput = false;
-             for (const auto& c : connections) { if (c.toNodeId == n.id) hasInput = true; }
-             if (!hasInput) { currentNodeId = n.id; ss << n.regexValue; break; }
-         }
-    }
-    if (currentNodeId == -1) return "";
-
-    int safety = 0;
-    bool foundNext = true;
-    while (foundNext && safety < 100) {
-        foundNext = false; safety++;
-        for (const auto& conn : connections) {
-            if (conn.fromNodeId == currentNodeId) {
-                currentNodeId = conn.toNodeId;
-                for (const auto& n : nodes) { if (n.id == currentNodeId) { ss << n.regexValue; break; } }
-                foundNext = true; break; 
+        if (node.type == NODE_START) { currentNodeId = node.id; break; }
+    }
+    if (currentNodeId == -1) {
+        for (const auto& n : nodes) {
+            if (!graphIndex.incoming.count(n.id)) { currentNodeId = n.id; break; }
+        }
+    }
+
+    // Follow the first outgoing edge until the chain ends or loops back on itself
+    while (currentNodeId != -1 && !regexChain.position.count(currentNodeId)) {
+        const Node* n = FindNode(currentNodeId);
+        if (!n) break;
+        regexChain.position[currentNodeId] = regexChain.chain.size();
+        regexChain.chain.push_back(currentNodeId);
+        regexChain.offsets.push_back(regexChain.text.size());
+        regexChain.text += n->regexValue.view();
+        auto next = graphIndex.next.find(currentNodeId);
+        currentNodeId = (next == graphIndex.next.end()) ? -1 : next->second;
+    }
+    return regexChain.text;
+}
+
+// PATTERN SETS: Same walk as GenerateRegex for graphs that are not the canvas (or for the other
+// START chains on it). One regex per START node; a graph without START yields its first root.
+std::vector<std::string> ChainPatterns(const std::vector<Node>& graphNodes, const std::vector<Connection>& graphConns) {
+    std::unordered_map<int, int> next;
+    std::unordered_set<int> hasIncoming;
+    std::unordered_map<int, const Node*> byId;
+    for (const auto& c : graphConns) { next.emplace(c.fromNodeId, c.toNodeId); hasIncoming.insert(c.toNodeId); }
+    for (const auto& n : graphNodes) byId[n.id] = &n;
+    std::vector<int> starts;
+    for (const auto& n : graphNodes) if (n.type == NODE_START) starts.push_back(n.id);
+    if (starts.empty()) {
+        for (const auto& n : graphNodes) if (!hasIncoming.count(n.id)) { starts.push_back(n.id); break; }
+    }
+    std::vector<std::string> patterns;
+    for (int id : starts) {
+        std::string regex;
+        std::unordered_set<int> seen;
+        while (id != -1 && seen.insert(id).second) {
+            auto node = byId.find(id);
+            if (node == byId.end()) break;
+            regex += node->second->regexValue.view();
+            auto it = next.find(id);
+            id = (it == next.end()) ? -1 : it->second;
+        }
+        patterns.push_back(regex);
+    }
+    return patterns;
+}
+
+// Fills opts.patterns / patternNames from a comma separated list of .vreg files or directories
+bool CollectProjectPatterns(const std::string& list, ScanOptions& opts, std::string& error) {
+    std::vector<std::string> files;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        std::error_code ec;
+        if (std::filesystem::is_directory(item, ec)) {
+            std::vector<std::string> found;
+            for (const auto& entry : std::filesystem::directory_iterator(item, ec)) {
+                if (entry.path().extension() == ".vreg") found.push_back(entry.path().string());
             }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else files.push_back(ProjectPath(item));
+    }
+    for (const auto& file : files) {
+        std::vector<Node> fileNodes;
+        std::vector<Connection> fileConns;
+        int unusedNextId = 0;
+        if (!ReadProjectFile(file, fileNodes, fileConns, unusedNextId, error)) return false;
+        std::vector<std::string> chains = ChainPatterns(fileNodes, fileConns);
+        std::string name = std::filesystem::path(file).stem().string();
+        for (size_t k = 0; k < chains.size(); k++) {
+            if (chains[k].empty()) continue;
+            opts.patterns.push_back(chains[k]);
+            opts.patternNames.push_back(chains.size() > 1 ? name + "#" + std::to_string(k + 1) : name);
+        }
+    }
+    if (opts.patterns.empty()) { error = "no patterns found in " + list; return false; }
+    return true;
+}
+
+// Blames every node whose fragment of the generated regex overlaps a finding (worst level wins)
+void MarkRiskNodes(const PatternRisk& risk, std::unordered_map<int, RiskLevel>& out) {
+    out.clear();
+    const std::vector<size_t>& offsets = regexChain.offsets;
+    for (const auto& f : risk.findings) {
+        size_t k = std::upper_bound(offsets.begin(), offsets.end(), f.from) - offsets.begin();
+        if (k > 0) k--;
+        for (; k < offsets.size() && offsets[k] < f.to; k++) {
+            RiskLevel& level = out[regexChain.chain[k]];
+            level = std::max(level, f.level);
         }
     }
-    return ss.str();
+}
+
+std::string FormatPatternRisk(const PatternRisk& risk) {
+    if (!risk.analyzed) return "Complexity: not analysed (pattern does not parse)";
+    if (risk.findings.empty()) return "Complexity: " + risk.Complexity() + " per match attempt, no ReDoS-prone shapes";
+    return "[WARN] Complexity: worst case " + risk.Complexity() + " per match attempt (" + risk.findings[0].reason + ")";
+}
+
+Color RiskColor(RiskLevel level) {
+    return level == RISK_EXPONENTIAL ? COL_RISK_EXP : COL_RISK_POLY;
 }
 
 void DrawGrid2D(int slices, float spacing) {
@@ -434,13 +1036,365 @@ void DrawGrid2D(int slices, float spacing) {
     for (float y = startY; y < bottomRight.y + spacing; y += spacing) DrawLineV({topLeft.x, y}, {bottomRight.x, y}, COL_GRID);
 }
 
+// World-space rectangle the camera shows, padded so outlines and text at the border are kept
+Rectangle VisibleWorldRect(int screenW, int screenH, float pad) {
+    Vector2 topLeft = GetScreenToWorld2D({0, 0}, camera);
+    Vector2 bottomRight = GetScreenToWorld2D({(float)screenW, (float)screenH}, camera);
+    return { topLeft.x - pad, topLeft.y - pad, bottomRight.x - topLeft.x + pad * 2, bottomRight.y - topLeft.y + pad * 2 };
+}
+
+// Same strip as raylib's DrawLineBezier: x advances linearly, y follows a cubic ease in-out
+void TessellateWire(WireMesh& mesh, Vector2 s, Vector2 e, float thick) {
+    mesh.start = s; mesh.end = e;
+    Vector2 prev = s;
+    for (int i = 1; i <= WIRE_SEGMENTS; i++) {
+        float t = (float)i / (WIRE_SEGMENTS * 0.5f), ease;
+        if (t < 1) ease = 0.5f * t * t * t;
+        else { t -= 2; ease = 0.5f * (t * t * t + 2); }
+        Vector2 cur = { prev.x + (e.x - s.x) / WIRE_SEGMENTS, s.y + (e.y - s.y) * ease };
+        float dx = cur.x - prev.x, dy = cur.y - prev.y;
+        float len = sqrtf(dx * dx + dy * dy);
+        float size = len > 0 ? 0.5f * thick / len : 0;
+        if (i == 1) {
+            mesh.strip[0] = { prev.x + dy * size, prev.y - dx * size };
+            mesh.strip[1] = { prev.x - dy * size, prev.y + dx * size };
+        }
+        mesh.strip[2 * i] = { cur.x + dy * size, cur.y - dx * size };
+        mesh.strip[2 * i + 1] = { cur.x - dy * size, cur.y + dx * size };
+        prev = cur;
+    }
+}
+
+// Draws the connections whose curve box meets 'view'; off-screen wires are neither tessellated nor drawn
+void DrawWires(const Rectangle& view, float thick, Color color) {
+    if (wireCache.revision != graphIndex.revision || wireCache.meshes.size() != connections.size()) {
+        wireCache.meshes.assign(connections.size(), WireMesh());
+        wireCache.revision = graphIndex.revision;
+    }
+    for (size_t i = 0; i < connections.size(); i++) {
+        const Node* from = FindNode(connections[i].fromNodeId);
+        const Node* to = FindNode(connections[i].toNodeId);
+        if (!from || !to) continue;
+        Vector2 s = { from->rect.x + from->rect.width, from->rect.y + from->rect.height/2 };
+        Vector2 e = { to->rect.x, to->rect.y + to->rect.height/2 };
+        // The eased curve never leaves the box spanned by its endpoints
+        Rectangle box = { std::min(s.x, e.x) - thick, std::min(s.y, e.y) - thick, std::abs(e.x - s.x) + thick * 2, std::abs(e.y - s.y) + thick * 2 };
+        if (!CheckCollisionRecs(box, view)) continue;
+        WireMesh& mesh = wireCache.meshes[i];
+        if (mesh.start.x != s.x || mesh.start.y != s.y || mesh.end.x != e.x || mesh.end.y != e.y) {
+            TessellateWire(mesh, s, e, thick);
+            canvasStats.wiresTessellated++;
+        }
+        DrawTriangleStrip(mesh.strip, 2 * WIRE_SEGMENTS + 2, color);
+        canvasStats.wiresDrawn++;
+    }
+}
+
 // CONSOLE & DEBUGGER UTILS
 void AddLog(std::string msg) {
+    if (headlessMode) { fprintf(stderr, "%s\n", msg.c_str()); return; }
     consoleLog.push_back(msg);
     if (consoleLog.size() > 1000) consoleLog.erase(consoleLog.begin());
     consoleScrollIndex = consoleLog.size(); 
 }
 
+std::string FormatBytes(double bytes) {
+    char buf[32];
+    if (bytes >= 1024.0 * 1024 * 1024) snprintf(buf, sizeof(buf), "%.2f GB", bytes / (1024.0 * 1024 * 1024));
+    else if (bytes >= 1024.0 * 1024) snprintf(buf, sizeof(buf), "%.1f MB", bytes / (1024.0 * 1024));
+    else snprintf(buf, sizeof(buf), "%.1f KB", bytes / 1024.0);
+    return buf;
+}
+
+// Moves finished hits from the scan workers into the console and retires the job when done
+void PumpScanResults() {
+    if (!activeScan) return;
+    std::vector<ScanHit> hits;
+    bool isSet = activeScan->PatternCount() > 1;
+    auto logHits = [&]() {
+        for (const auto& hit : hits) {
+            std::string label = (isSet && hit.pattern >= 0) ? " [" + activeScan->PatternName(hit.pattern) + "]" : "";
+            if (!hit.warning.empty()) { AddLog("[WARN] " + hit.path + label + ": " + hit.warning); continue; }
+            AddLog("HIT: " + hit.path + label + " (" + std::to_string(hit.count) + ")");
+            for (const auto& loc : hit.locations) {
+                AddLog("  " + hit.path + ":" + std::to_string(loc.line) + ":" + std::to_string(loc.column) + ": " + loc.text);
+            }
+        }
+        hits.clear();
+    };
+    activeScan->results.Drain(hits);
+    logHits();
+    if (!activeScan->finished) return;
+
+    activeScan->Wait();
+    activeScan->results.Drain(hits);
+    logHits();
+    char secs[32];
+    snprintf(secs, sizeof(secs), "%.2fs", activeScan->ElapsedSeconds());
+    std::string summary = "Scanned " + std::to_string(activeScan->filesScanned.load()) + " files (" + FormatBytes((double)activeScan->bytesScanned.load()) +
+                          ", " + secs + "). Matches: " + std::to_string(activeScan->totalMatches.load());
+    if (activeScan->filesAborted) summary += " | " + std::to_string(activeScan->filesAborted.load()) + " file(s) aborted (match budget or bad archive)";
+    if (activeScan->filesUnreadable) summary += " | " + std::to_string(activeScan->filesUnreadable.load()) + " file(s) unreadable";
+    if (activeScan->filesCached || activeScan->filesResumed) {
+        summary += " | Cache: " + std::to_string(activeScan->filesCached.load()) + " unchanged, " + std::to_string(activeScan->filesResumed.load()) +
+                   " resumed, " + FormatBytes((double)activeScan->bytesReused.load()) + " not re-read";
+    }
+    if (activeScan->archivesScanned) {
+        summary += " | " + std::to_string(activeScan->archivesScanned.load()) + " archive(s), " + FormatBytes((double)activeScan->bytesInflated.load()) + " decompressed";
+    }
+    if (activeScan->filesFiltered || activeScan->filesBinary || activeScan->dirsPruned) {
+        summary += " | Skipped: " + std::to_string(activeScan->filesFiltered.load()) + " filtered, " + std::to_string(activeScan->filesBinary.load()) +
+                   " binary, " + std::to_string(activeScan->dirsPruned.load()) + " dir(s) pruned";
+    }
+    AddLog((activeScan->Cancelled() ? "[CANCELLED] " : "[DONE] ") + summary);
+    if (!activeScan->cacheStatus.empty()) AddLog("[WARN] Scan cache: " + activeScan->cacheStatus);
+    if (isSet) {
+        for (size_t p = 0; p < activeScan->PatternCount(); p++) {
+            AddLog("  " + activeScan->PatternName(p) + ": " + std::to_string(activeScan->patternMatches[p].load()));
+        }
+    }
+    activeScan.reset();
+}
+
+// Logs the bench table once the job is done and writes the requested exports
+void PumpBenchResults() {
+    if (!activeBench || !activeBench->finished) return;
+    activeBench->Wait();
+    for (const auto& r : activeBench->results) AddLog("  " + FormatBenchResult(r));
+    if (!benchCsvPath.empty()) {
+        if (WriteBenchCsv(benchCsvPath, *activeBench, benchPattern)) AddLog("[SUCCESS] Bench CSV written: " + benchCsvPath);
+        else AddLog("[ERROR] Cannot write " + benchCsvPath);
+    }
+    if (!benchJsonPath.empty()) {
+        if (WriteBenchJson(benchJsonPath, *activeBench, benchPattern)) AddLog("[SUCCESS] Bench JSON written: " + benchJsonPath);
+        else AddLog("[ERROR] Cannot write " + benchJsonPath);
+    }
+    AddLog(activeBench->Cancelled() ? "[CANCELLED] Bench stopped." : "[DONE] Bench finished.");
+    activeBench.reset();
+}
+
+// One-line progress readout for the terminal: files/s, MB/s and ETA (once the walk is complete)
+std::string FormatScanProgress(const FileScanner& scan, float& fraction) {
+    double elapsed = std::max(0.001, scan.ElapsedSeconds());
+    uint64_t files = scan.filesScanned, filesTotal = scan.filesQueued;
+    uint64_t bytes = scan.bytesScanned, bytesTotal = scan.bytesQueued;
+    double bytesPerSec = bytes / elapsed;
+    fraction = bytesTotal > 0 ? (float)((double)bytes / bytesTotal) : 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+
+    char buf[160];
+    std::string eta = "--";
+    if (scan.producerDone && bytesPerSec > 0) {
+        char etaBuf[32];
+        double remaining = bytesTotal > bytes ? (bytesTotal - bytes) / bytesPerSec : 0.0;
+        snprintf(etaBuf, sizeof(etaBuf), "%.0fs", remaining);
+        eta = etaBuf;
+    }
+    snprintf(buf, sizeof(buf), "%llu/%llu%s files | %.0f files/s | %.1f MB/s | ETA %s",
+             (unsigned long long)files, (unsigned long long)filesTotal, scan.producerDone ? "" : "+",
+             files / elapsed, bytesPerSec / (1024.0 * 1024.0), eta.c_str());
+    return buf;
+}
+
+// SCAN TELEMETRY: Rates are sampled twice a second so the overlay numbers stay readable
+struct ScanTelemetry {
+    const FileScanner* scan = nullptr;
+    double sampledAt = 0;
+    uint64_t files = 0, bytes = 0, matches = 0;
+    std::vector<uint64_t> busyUs;
+    double filesPerSec = 0, bytesPerSec = 0, matchesPerSec = 0;
+    std::vector<float> utilization; // 0..1 per worker
+};
+ScanTelemetry scanTelemetry;
+
+void SampleScanTelemetry(const FileScanner& scan) {
+    ScanTelemetry& t = scanTelemetry;
+    double now = profiler.NowUs();
+    if (t.scan != &scan) {
+        t = ScanTelemetry();
+        t.scan = &scan;
+        t.sampledAt = now;
+        t.busyUs.assign(scan.workerCount, 0);
+        t.utilization.assign(scan.workerCount, 0.0f);
+        return;
+    }
+    double dt = now - t.sampledAt;
+    if (dt < 500000) return;
+    uint64_t files = scan.filesScanned, bytes = scan.bytesScanned, matches = scan.totalMatches;
+    t.filesPerSec = (files - t.files) * 1e6 / dt;
+    t.bytesPerSec = (bytes - t.bytes) * 1e6 / dt;
+    t.matchesPerSec = (matches - t.matches) * 1e6 / dt;
+    for (unsigned i = 0; i < scan.workerCount; i++) {
+        uint64_t busy = scan.workerBusyUs[i];
+        t.utilization[i] = (float)std::min(1.0, (busy - t.busyUs[i]) / dt);
+        t.busyUs[i] = busy;
+    }
+    t.files = files; t.bytes = bytes; t.matches = matches;
+    t.sampledAt = now;
+}
+
+const Color PROFILE_ZONE_COLORS[PROF_ZONE_COUNT] = { SKYBLUE, ORANGE, GREEN, PURPLE, GRAY };
+
+// PROFILER OVERLAY (F3): Last/average zone times, allocations, a frame history graph and,
+// while a scan runs, its throughput and per-worker utilization
+void DrawProfilerOverlay(int screenW) {
+    const int avgFrames = 60;
+    size_t frames = std::min<size_t>(profiler.FrameCount(), avgFrames);
+    const FrameProfile* last = profiler.Frame(0);
+    if (!last) return;
+    float avgZone[PROF_ZONE_COUNT] = {}, avgTotal = 0, maxTotal = 0, avgAllocs = 0;
+    for (size_t k = 0; k < frames; k++) {
+        const FrameProfile* f = profiler.Frame(k);
+        for (int z = 0; z < PROF_ZONE_COUNT; z++) avgZone[z] += f->zoneMs[z] / frames;
+        avgTotal += f->totalMs / frames;
+        avgAllocs += (float)f->allocations / frames;
+        maxTotal = std::max(maxTotal, f->totalMs);
+    }
+
+    bool scanning = activeScan != nullptr;
+    if (scanning) SampleScanTelemetry(*activeScan);
+    int workers = scanning ? (int)activeScan->workerCount : 0;
+    Rectangle panel = { (float)screenW - 380, 90, 370, 332.0f + (scanning ? 70.0f + 14.0f * workers : 0.0f) };
+    DrawRectangleRec(panel, Fade(BLACK, 0.85f));
+    DrawRectangleLinesEx(panel, 1, GRAY);
+    float x = panel.x + 10, y = panel.y + 8;
+    char buf[160];
+    snprintf(buf, sizeof(buf), "PROFILER  %.1f ms avg  %.1f ms max  (%.0f fps)", avgTotal, maxTotal, avgTotal > 0 ? 1000.0f / avgTotal : 0.0f);
+    DrawTextEx(mainFont, buf, { x, y }, 16, 1.0f, YELLOW);
+    y += 24;
+    DrawTextEx(mainFont, "zone        last ms   avg ms", { x, y }, 14, 1.0f, GRAY);
+    y += 18;
+    float zoneSum = 0;
+    for (int z = 0; z < PROF_ZONE_COUNT; z++) {
+        snprintf(buf, sizeof(buf), "%-10s %8.2f %8.2f", PROFILE_ZONE_NAMES[z], last->zoneMs[z], avgZone[z]);
+        DrawRectangle((int)x, (int)y + 3, 8, 8, PROFILE_ZONE_COLORS[z]);
+        DrawTextEx(mainFont, buf, { x + 14, y }, 14, 1.0f, WHITE);
+        zoneSum += avgZone[z];
+        y += 16;
+    }
+    snprintf(buf, sizeof(buf), "%-10s %8s %8.2f  (input, vsync)", "other", "", std::max(0.0f, avgTotal - zoneSum));
+    DrawTextEx(mainFont, buf, { x + 14, y }, 14, 1.0f, LIGHTGRAY);
+    y += 20;
+    snprintf(buf, sizeof(buf), "allocations/frame: %u last, %.0f avg", last->allocations, avgAllocs);
+    DrawTextEx(mainFont, buf, { x, y }, 14, 1.0f, WHITE);
+    y += 16;
+    snprintf(buf, sizeof(buf), "canvas: %zu/%zu nodes, %zu/%zu wires drawn, %zu re-tessellated", canvasStats.nodesDrawn, nodes.size(),
+             canvasStats.wiresDrawn, connections.size(), canvasStats.wiresTessellated);
+    DrawTextEx(mainFont, buf, { x, y }, 14, 1.0f, WHITE);
+    y += 16;
+    snprintf(buf, sizeof(buf), "node text: %zu interned strings, %s pool", nodeStrings.Count(), FormatBytes((double)nodeStrings.Bytes()).c_str());
+    DrawTextEx(mainFont, buf, { x, y }, 14, 1.0f, WHITE);
+    y += 20;
+
+    // Frame history, newest on the right; the line marks 16.7 ms
+    const float graphH = 80, msScale = graphH / 33.3f;
+    Rectangle graph = { x, y, panel.width - 20, graphH };
+    DrawRectangleRec(graph, Fade(DARKGRAY, 0.4f));
+    float colW = graph.width / PROFILE_HISTORY;
+    for (size_t k = 0; k < profiler.FrameCount(); k++) {
+        const FrameProfile* f = profiler.Frame(k);
+        float cx = graph.x + graph.width - (k + 1) * colW, base = graph.y + graphH;
+        for (int z = 0; z < PROF_ZONE_COUNT; z++) {
+            float h = std::min(f->zoneMs[z] * msScale, base - graph.y);
+            if (h <= 0) continue;
+            DrawRectangle((int)cx, (int)(base - h), std::max(1, (int)colW), (int)std::max(1.0f, h), PROFILE_ZONE_COLORS[z]);
+            base -= h;
+        }
+        float total = std::min(f->totalMs * msScale, graphH);
+        DrawRectangle((int)cx, (int)(graph.y + graphH - total), std::max(1, (int)colW), 1, WHITE);
+    }
+    DrawLine((int)graph.x, (int)(graph.y + graphH - 16.7f * msScale), (int)(graph.x + graph.width), (int)(graph.y + graphH - 16.7f * msScale), Fade(RED, 0.6f));
+    y += graphH + 8;
+    DrawTextEx(mainFont, profiler.Tracing() ? "trace: RECORDING ('trace stop <file.json>')" : "trace: off ('trace start')", { x, y }, 14, 1.0f,
+               profiler.Tracing() ? RED : GRAY);
+    y += 22;
+
+    if (!scanning) return;
+    const ScanTelemetry& t = scanTelemetry;
+    DrawTextEx(mainFont, "SCAN", { x, y }, 16, 1.0f, YELLOW);
+    y += 20;
+    snprintf(buf, sizeof(buf), "read %s | %.1f MB/s | %.0f files/s", FormatBytes((double)activeScan->bytesScanned.load()).c_str(),
+             t.bytesPerSec / (1024.0 * 1024.0), t.filesPerSec);
+    DrawTextEx(mainFont, buf, { x, y }, 14, 1.0f, WHITE);
+    y += 16;
+    snprintf(buf, sizeof(buf), "%llu matches | %.0f matches/s", (unsigned long long)activeScan->totalMatches.load(), t.matchesPerSec);
+    DrawTextEx(mainFont, buf, { x, y }, 14, 1.0f, WHITE);
+    y += 20;
+    for (int i = 0; i < workers; i++) {
+        float u = i < (int)t.utilization.size() ? t.utilization[i] : 0.0f;
+        snprintf(buf, sizeof(buf), "w%-2d %3.0f%%", i, u * 100);
+        DrawTextEx(mainFont, buf, { x, y }, 12, 1.0f, LIGHTGRAY);
+        DrawRectangle((int)x + 70, (int)y + 2, (int)((panel.width - 90) * u), 9, u > 0.8f ? GREEN : ORANGE);
+        y += 14;
+    }
+}
+
+// Launches the background scan job for the current pattern, or for opts.patterns when a set was given
+void StartScan(const std::string& target, ScanOptions opts) {
+    std::string regStr = GenerateRegex();
+    if (regStr.empty() && opts.patterns.empty()) { AddLog("[ERROR] Empty Regex (Add nodes first)."); return; }
+
+    std::filesystem::path path(target);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) { AddLog("[ERROR] Path not found: " + target); return; }
+    if (activeScan) { AddLog("[ERROR] A scan is already running. Type 'cancel' to stop it."); return; }
+
+    AddLog("Scanning path: " + target + (opts.stream ? " (stream)" : "") +
+           (opts.patterns.size() > 1 ? " with " + std::to_string(opts.patterns.size()) + " patterns" : ""));
+    opts.pattern = regStr;
+    opts.engine = currentEngine;
+    activeScan.reset(new FileScanner());
+    std::string engineError;
+    if (!activeScan->Start(path, opts, engineError)) {
+        AddLog("[ERROR] Regex Engine: " + engineError);
+        activeScan.reset();
+        return;
+    }
+    if (activeScan->PatternCount() > 1) {
+        size_t gated = 0;
+        for (const auto& pf : activeScan->prefilters) if (pf.Active()) gated++;
+        AddLog("Prefilter: " + std::to_string(gated) + "/" + std::to_string(activeScan->PatternCount()) + " patterns gated by one literal-set pass per file");
+        return;
+    }
+    const LiteralPrefilter& pf = activeScan->prefilters[0];
+    if (pf.Active()) AddLog("Prefilter: literal \"" + pf.literal + "\"" + (pf.lineMode ? " (line mode)" : ""));
+}
+
+// bench [--runs <n>] [--csv <file>] [--json <file>] <path|sample>
+void StartBench(std::stringstream& ss) {
+    BenchOptions opts;
+    std::string token, target, csvPath, jsonPath;
+    while (ss >> token) {
+        if (token == "--runs") {
+            if (!(ss >> opts.runs) || opts.runs <= 0) { target.clear(); break; }
+        }
+        else if (token == "--csv") ss >> csvPath;
+        else if (token == "--json") ss >> jsonPath;
+        else {
+            std::string rest;
+            std::getline(ss, rest);
+            target = token + rest;
+            break;
+        }
+    }
+    if (target.empty()) { AddLog("[USAGE] bench [--runs <n>] [--csv <file>] [--json <file>] <path|sample>"); return; }
+
+    opts.pattern = GenerateRegex();
+    if (opts.pattern.empty()) { AddLog("[ERROR] Empty Regex (Add nodes first)."); return; }
+    if (activeBench) { AddLog("[ERROR] A bench is already running. Type 'cancel' to stop it."); return; }
+
+    std::unique_ptr<BenchJob> job(new BenchJob());
+    std::string error;
+    if (target == "sample") job->UseText(playgroundText);
+    else if (!job->OpenFile(target, error)) { AddLog("[ERROR] " + error); return; }
+    AddLog("Bench: " + job->source + " (" + FormatBytes((double)job->inputSize) + "), " + std::to_string(opts.runs) + " run(s) per engine");
+    benchPattern = opts.pattern;
+    benchCsvPath = csvPath;
+    benchJsonPath = jsonPath;
+    job->Start(opts);
+    activeBench = std::move(job);
+}
+
 void ProcessConsoleCommand() {
     if (consoleInput.empty()) return;
     
@@ -462,8 +1416,13 @@ void ProcessConsoleCommand() {
             filename.erase(0, filename.find_first_not_of(" \t\n\r"));
             filename.erase(filename.find_last_not_of(" \t\n\r") + 1);
         }
-        if (filename.empty()) AddLog("[USAGE] save <filename>");
-        else SaveProject(filename);
+        bool textFormat = filename.rfind("--text", 0) == 0;
+        if (textFormat) {
+            filename.erase(0, 6);
+            filename.erase(0, filename.find_first_not_of(" \t\n\r"));
+        }
+        if (filename.empty()) AddLog("[USAGE] save [--text] <filename>");
+        else SaveProject(filename, textFormat);
     }
     else if (command == "load") {
         std::string filename;
@@ -475,100 +1434,510 @@ void ProcessConsoleCommand() {
         if (filename.empty()) AddLog("[USAGE] load <filename>");
         else LoadProject(filename);
     }
+    else if (command == "load-sample") {
+        std::string filename;
+        std::getline(ss, filename);
+        filename.erase(0, filename.find_first_not_of(" \t\n\r"));
+        if (!filename.empty()) filename.erase(filename.find_last_not_of(" \t\n\r") + 1);
+        std::string error;
+        if (filename.empty()) AddLog("[USAGE] load-sample <file>");
+        else if (!playgroundText.Load(filename, error)) AddLog("[ERROR] " + error);
+        else {
+            playgroundRevision++;
+            playgroundScrollOffset = 0;
+            showPlayground = true;
+            if (isDebugging) AnalyzeMatchesForDebug();
+            AddLog("[SUCCESS] Sample loaded into the playground: " + FormatBytes((double)playgroundText.size()));
+        }
+    }
+    else if (command == "import") {
+        // import <regex> | import --file <path> (one pattern, trailing newline ignored)
+        std::string pattern;
+        std::getline(ss, pattern);
+        pattern.erase(0, pattern.find_first_not_of(" \t"));
+        if (pattern.rfind("--file ", 0) == 0) {
+            std::string path = pattern.substr(7);
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) { AddLog("[ERROR] Could not open " + path); consoleInput = ""; return; }
+            std::stringstream buffer; buffer << file.rdbuf(); pattern = buffer.str();
+            while (!pattern.empty() && (pattern.back() == '\n' || pattern.back() == '\r')) pattern.pop_back();
+        }
+        if (pattern.empty()) { AddLog("[USAGE] import <regex> | import --file <path>"); consoleInput = ""; return; }
+        bool wasEmpty = nodes.empty();
+        size_t before = nodes.size();
+        double t0 = profiler.NowUs();
+        std::string error;
+        if (!ImportRegex(pattern, GetScreenToWorld2D({ 40, 120 }, camera), error)) { AddLog("[ERROR] import: " + error); consoleInput = ""; return; }
+        char took[32];
+        snprintf(took, sizeof(took), "%.1f ms", (profiler.NowUs() - t0) / 1000.0);
+        AddLog("[SUCCESS] Imported " + std::to_string(nodes.size() - before) + " nodes (" + took + ").");
+        if (!wasEmpty) AddLog("[WARN] The canvas already had nodes: the generated regex still follows the first chain.");
+        else if (GetCurrentRegex() != pattern) AddLog("[WARN] The generated regex differs from the imported one.");
+    }
+    else if (command == "history") {
+        long long depth = 0;
+        if (ss >> depth) {
+            if (depth <= 0) { AddLog("[USAGE] history [depth]"); consoleInput = ""; return; }
+            CloseEditTransaction();
+            editHistory.SetDepth((size_t)depth);
+            AddLog("[SUCCESS] Undo depth set to " + std::to_string(depth) + ".");
+        }
+        AddLog(FormatHistoryStats());
+    }
+    else if (command == "export-native") {
+        // export-native <file.hpp> [namespace]
+        std::string filename, ns;
+        ss >> filename >> ns;
+        if (ns.empty()) ns = "regex_studio_matcher";
+        std::string regStr = GenerateRegex();
+        std::string code, error;
+        bool validNs = !isdigit((unsigned char)ns[0]);
+        for (char c : ns) if (!isalnum((unsigned char)c) && c != '_') validNs = false;
+        if (filename.empty() || !validNs) AddLog("[USAGE] export-native <file.hpp> [namespace]");
+        else if (regStr.empty()) AddLog("[ERROR] Empty Regex (Add nodes first).");
+        else if (!GenerateNativeMatcher(regStr, ns, code, error)) AddLog("[ERROR] Native matcher: " + error);
+        else {
+            std::ofstream out(filename, std::ios::binary);
+            out << code;
+            if (!out) AddLog("[ERROR] Could not write file: " + filename);
+            else AddLog("[SUCCESS] Native matcher header written: " + std::filesystem::absolute(filename).string() + " (" + FormatBytes((double)code.size()) + ")");
+        }
+    }
+    else if (command == "analyze") {
+        const std::string& regStr = GetCurrentRegex();
+        if (regStr.empty()) AddLog("[ERROR] Empty Regex (Add nodes first).");
+        else {
+            const PatternRisk& risk = patternCache.risk;
+            AddLog(FormatPatternRisk(risk));
+            for (const auto& f : risk.findings) {
+                AddLog("  " + std::string(f.level == RISK_EXPONENTIAL ? "exponential" : "polynomial") + " at \"" +
+                       regStr.substr(f.from, f.to - f.from) + "\": " + f.reason);
+            }
+        }
+    }
+    else if (command == "cancel") {
+        if (activeScan) { activeScan->Cancel(); AddLog("Cancelling scan..."); }
+        if (activeBench) { activeBench->Cancel(); AddLog("Cancelling bench..."); }
+        if (!activeScan && !activeBench) AddLog("[USAGE] cancel (stops the running scan or bench)");
+    }
+    else if (command == "bench") {
+        StartBench(ss);
+    }
+    else if (command == "profile") {
+        showProfiler = !showProfiler;
+    }
+    else if (command == "trace") {
+        std::string action, path;
+        ss >> action >> path;
+        if (action == "start") {
+            profiler.StartTrace();
+            AddLog("Tracing... ('trace stop <file.json>' to write it)");
+        }
+        else if (action == "stop" && !path.empty()) {
+            if (!profiler.Tracing()) { AddLog("[ERROR] No trace is recording."); consoleInput = ""; return; }
+            std::vector<TraceEvent> events;
+            bool truncated = false;
+            profiler.StopTrace(events, truncated);
+            if (!WriteChromeTrace(path, events)) AddLog("[ERROR] Could not write " + path);
+            else {
+                AddLog("[SUCCESS] Wrote " + std::to_string(events.size()) + " trace events to " + path);
+                if (truncated) AddLog("[WARN] Trace stopped at " + std::to_string(TRACE_MAX_EVENTS) + " events.");
+            }
+        }
+        else AddLog("[USAGE] trace start | trace stop <file.json>");
+    }
+    else if (command == "engine") {
+        std::string name;
+        ss >> name;
+        if (name.empty()) AddLog("Engine: " + std::string(EngineTypeName(currentEngine)) + (patternCache.engine ? " (active: " + std::string(patternCache.engine->Name()) + ")" : ""));
+        else if (name == "std" || name == "dfa" || name == "auto") {
+            currentEngine = (name == "std") ? ENGINE_STD : (name == "dfa") ? ENGINE_DFA : ENGINE_AUTO;
+            patternCache.graphRev = -1; // force recompile with the new backend
+            patternCache.matchGraphRev = -1;
+            GetCurrentRegex();
+            if (isDebugging) AnalyzeMatchesForDebug();
+            if (!patternCache.regexStr.empty() && !patternCache.compiled) AddLog("[ERROR] " + name + " engine: " + patternCache.compileError);
+            else AddLog("[SUCCESS] Engine set to " + name + ".");
+        }
+        else AddLog("[USAGE] engine <std|dfa|auto>");
+    }
+    else if (command == "scan") {
+        // scan [--stream] [--lines] [--max <n>] [--chunk <bytes>] [--overlap <bytes>] [--set <a.vreg,b.vreg|dir>] [--chains]
+        //      [--include <globs>] [--exclude <globs>] [--max-size <n[k|m|g]>] [--gitignore] [--all] [--cache <file>] <path>
+        ScanOptions opts;
+        std::string token, target;
+        bool badArgs = false;
+        while (ss >> token) {
+            if (token == "--stream") opts.stream = true;
+            else if (token == "--lines") opts.lines = true;
+            else if (token == "--set") {
+                std::string list, error;
+                if (!(ss >> list) || !CollectProjectPatterns(list, opts, error)) { AddLog("[ERROR] " + (error.empty() ? "missing project list" : error)); consoleInput = ""; return; }
+            }
+            else if (token == "--chains") {
+                // Every START chain on the canvas is one pattern of the set
+                std::vector<std::string> chains = ChainPatterns(nodes, connections);
+                for (size_t k = 0; k < chains.size(); k++) {
+                    if (chains[k].empty()) continue;
+                    opts.patterns.push_back(chains[k]);
+                    opts.patternNames.push_back("chain " + std::to_string(k + 1));
+                }
+            }
+            else if (token == "--include" || token == "--exclude") {
+                std::string list;
+                if (!(ss >> list)) { badArgs = true; break; }
+                AddGlobs(token == "--include" ? opts.include : opts.exclude, list);
+            }
+            else if (token == "--max-size") {
+                std::string size;
+                if (!(ss >> size) || !ParseByteSize(size, opts.maxFileSize)) { badArgs = true; break; }
+            }
+            else if (token == "--gitignore") opts.gitignore = true;
+            else if (token == "--all") { opts.skipBinary = false; opts.skipVcs = false; }
+            else if (token == "--cache") {
+                if (!(ss >> opts.cachePath)) { badArgs = true; break; }
+            }
+            else if (token == "--chunk" || token == "--overlap" || token == "--max") {
+                long long v = 0;
+                if (!(ss >> v) || v <= 0) { badArgs = true; break; }
+                if (token == "--chunk") opts.chunkSize = (size_t)v;
+                else if (token == "--overlap") opts.overlap = (size_t)v;
+                else opts.maxLocations = (size_t)v;
+            }
+            else {
+                std::string rest;
+                std::getline(ss, rest);
+                target = token + rest;
+                break;
+            }
+        }
+        if (badArgs || target.empty()) {
+            AddLog("[USAGE] scan [--stream] [--lines] [--max <n>] [--chunk <bytes>] [--overlap <bytes>] [--set <a.vreg,b.vreg|dir>] [--chains]");
+            AddLog("             [--include <globs>] [--exclude <globs>] [--max-size <n[k|m|g]>] [--gitignore] [--all] [--cache <file>] <path>");
+        }
+        else {
+            if (opts.chunkSize < 4096) opts.chunkSize = 4096;
+            StartScan(target, opts);
+        }
+    }
     else {
         // Fallback: Treat whole string as Path
-        std::string regStr = GenerateRegex();
-        if (regStr.empty()) { AddLog("[ERROR] Empty Regex (Add nodes first)."); consoleInput = ""; return; }
-
         std::filesystem::path path(cleanInput);
         std::error_code ec;
-        if (!std::filesystem::exists(path, ec)) { 
-            AddLog("[ERROR] Unknown command or Path not found: " + cleanInput); 
-            consoleInput = ""; 
-            return; 
-        }
-
-        AddLog("Scanning path: " + cleanInput);
-        try {
-            std::regex pattern(regStr);
-            int totalMatches = 0;
-            int filesScanned = 0;
-            auto processFile = [&](const std::filesystem::path& filePath) {
-                std::ifstream file(filePath);
-                if (!file.is_open()) return;
-                std::stringstream buffer; buffer << file.rdbuf(); std::string content = buffer.str();
-                auto b = std::sregex_iterator(content.begin(), content.end(), pattern);
-                auto e = std::sregex_iterator();
-                int count = std::distance(b, e);
-                if (count > 0) { AddLog("HIT: " + filePath.filename().string() + " (" + std::to_string(count) + ")"); totalMatches += count; }
-                filesScanned++;
-            };
-            if (std::filesystem::is_directory(path)) {
-                for (const auto& entry : std::filesystem::directory_iterator(path)) if (entry.is_regular_file()) processFile(entry.path());
-            } else if (std::filesystem::is_regular_file(path)) processFile(path);
-            AddLog("[DONE] Scanned " + std::to_string(filesScanned) + " files. Matches: " + std::to_string(totalMatches));
-        } catch (const std::exception& e) { AddLog("[ERROR] Regex Engine: " + std::string(e.what())); }
+        if (!std::filesystem::exists(path, ec)) AddLog("[ERROR] Unknown command or Path not found: " + cleanInput);
+        else StartScan(cleanInput, ScanOptions());
     }
     consoleInput = "";
 }
 
-void AnalyzeMatchesForDebug(const std::string& patternStr) {
-    currentDebugMatches.clear();
-    try {
-        std::regex pattern(patternStr);
-        auto words_begin = std::sregex_iterator(playgroundText.begin(), playgroundText.end(), pattern);
-        auto words_end = std::sregex_iterator();
+// PATTERN CACHE: Regenerates the regex string and recompiles it only when graphRevision moved
+const std::string& GetCurrentRegex() {
+    if (patternCache.graphRev != graphRevision) {
+        ProfileScope scope(PROF_COMPILE); // complexity analysis; generation and compilation are nested zones
+        patternCache.graphRev = graphRevision;
+        patternCache.regexStr = GenerateRegex();
+        patternCache.compiled = false;
+        patternCache.engine.reset();
+        patternCache.compileError.clear();
+        if (!patternCache.regexStr.empty()) {
+            patternCache.engine = CompileEngine(currentEngine, patternCache.regexStr, patternCache.compileError);
+            patternCache.compiled = (patternCache.engine != nullptr);
+        }
+        patternCache.risk = AnalyzePatternComplexity(patternCache.regexStr);
+        MarkRiskNodes(patternCache.risk, patternCache.riskNodes);
+    }
+    return patternCache.regexStr;
+}
 
-        for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
-            std::smatch match = *i;
+// Appends matches to the table until it holds 'want' entries or the input is exhausted
+void ExtendDebugMatches(size_t want) {
+    DebugAnalysis& da = debugAnalysis;
+    if (da.complete || currentDebugMatches.size() >= want || !patternCache.compiled) return;
+    if (da.textRev != playgroundRevision || da.graphRev != graphRevision) return; // stale: EnsureDebugAnalysis rebuilds
+    ProfileScope scope(PROF_MATCH);
+    size_t size = playgroundText.size();
+    bool stopped = false;
+    try {
+        patternCache.engine->ForEach(da.text, da.text + size, da.resume, true, [&](const EngineMatch& match) {
+            // Resuming right after an empty match finds it again first; the engine then retries non-empty
+            if (match.length == 0 && (long)match.start == da.lastEmptyAt) return true;
+            if (currentDebugMatches.size() >= want) { stopped = true; return false; }
             DebugMatch dm;
-            dm.fullMatch = match.str();
-            dm.start = match.position();
-            dm.length = match.length();
+            dm.fullMatch = std::string(da.text + match.start, match.length);
+            dm.start = (int)match.start;
+            dm.length = (int)match.length;
             
-            for (size_t k = 1; k < match.size(); ++k) {
+            for (const auto& g : match.groups) {
                 DebugGroup dg;
-                dg.content = match[k].str();
-                dg.start = match.position(k);
-                dg.length = match.length(k);
+                dg.content = g.first >= 0 ? std::string(da.text + g.first, g.second) : "";
+                dg.start = (int)g.first;
+                dg.length = (int)g.second;
                 dm.groups.push_back(dg);
             }
             currentDebugMatches.push_back(dm);
-        }
+            da.resume = match.start + match.length;
+            da.lastEmptyAt = match.length == 0 ? (long)match.start : -1;
+            return true;
+        });
+    } catch (const MatchBudgetExceeded& e) {
+        da.warning = FormatMatchAbort(e);
+        stopped = false; // nothing past the aborted search
     } catch (...) {}
+    if (!stopped) da.complete = true;
+    debugRevision++;
+}
+
+void AnalyzeMatchesForDebug() {
+    ProfileScope scope(PROF_MATCH);
+    currentDebugMatches.clear();
+    debugRevision++;
+    GetCurrentRegex();
+    DebugAnalysis& da = debugAnalysis;
+    da.graphRev = graphRevision;
+    da.textRev = playgroundRevision;
+    da.resume = 0;
+    da.lastEmptyAt = -1;
+    da.warning.clear();
+    da.complete = !patternCache.compiled;
+    da.text = playgroundText.Contiguous(0, playgroundText.size(), da.scratch);
+    ExtendDebugMatches(playgroundText.size() < DEBUG_LAZY_THRESHOLD ? SIZE_MAX : DEBUG_BATCH);
     if (currentDebugMatchIndex >= (int)currentDebugMatches.size()) currentDebugMatchIndex = 0;
 }
 
-float CalculateWrappedHeight(const std::string& text, float fontSize, float maxWidth) {
-    float x = 0; float y = fontSize; 
-    for (size_t i = 0; i < text.length(); ++i) {
-        if (text[i] == '\n') { x = 0; y += fontSize; continue; }
-        char b[2] = { text[i], '\0' };
-        float w = MeasureTextEx(mainFont, b, fontSize, 1.0f).x;
-        if (x + w > maxWidth) { x = 0; y += fontSize; }
-        x += w;
+// Re-analyses when the pattern or the text moved since the table was built
+void EnsureDebugAnalysis() {
+    GetCurrentRegex();
+    if (debugAnalysis.graphRev != graphRevision || debugAnalysis.textRev != playgroundRevision) AnalyzeMatchesForDebug();
+}
+
+// Steps the debugger, analysing the next batch when it walks past the end of the table
+void StepDebugMatch(int delta) {
+    int count = (int)currentDebugMatches.size();
+    if (count == 0) return;
+    if (delta > 0) {
+        if (currentDebugMatchIndex + 1 >= count) ExtendDebugMatches(count + DEBUG_BATCH);
+        count = (int)currentDebugMatches.size();
+        currentDebugMatchIndex = (currentDebugMatchIndex + 1 < count) ? currentDebugMatchIndex + 1 : 0;
+    } else {
+        if (currentDebugMatchIndex > 0) currentDebugMatchIndex--;
+        else if (debugAnalysis.complete) currentDebugMatchIndex = count - 1;
+    }
+    debugRevision++;
+
+    // Bring the selected match into view
+    const TextLayout& layout = playgroundLayout;
+    if (!layout.lineStarts.empty()) {
+        size_t line = std::upper_bound(layout.lineStarts.begin(), layout.lineStarts.end(), (size_t)currentDebugMatches[currentDebugMatchIndex].start) - layout.lineStarts.begin() - 1;
+        float y = line * layout.fontSize;
+        if (y < playgroundScrollOffset || y > playgroundScrollOffset + playgroundViewHeight - layout.fontSize) {
+            playgroundScrollOffset = std::max(0.0f, y - playgroundViewHeight / 3);
+        }
     }
-    return y;
 }
 
-// Updated DrawTextWrapped to handle scrollOffset
-void DrawTextWrapped(Font font, const std::string& text, Rectangle rec, float fontSize, Color color, float scrollOffset) {
-    float x = 0; float y = 0;
-    for (size_t i = 0; i < text.length(); ++i) {
-        char c = text[i];
-        if (c == '\n') { x = 0; y += fontSize; continue; }
-        char b[2] = { c, '\0' };
-        float w = MeasureTextEx(font, b, fontSize, 1.0f).x;
-        
-        if (x + w > rec.width) { x = 0; y += fontSize; }
-        
-        // Drawing with culling
-        float drawY = rec.y + y - scrollOffset;
-        if (drawY + fontSize > rec.y && drawY < rec.y + rec.height) {
-            DrawTextEx(font, b, {rec.x + x, drawY}, fontSize, 1.0f, color);
+// Recomputes playground highlights only when the pattern, the text or the debugger selection changed,
+// or when the viewport [visibleFrom, visibleTo) scrolls out of the matched window
+void UpdatePlaygroundHighlights(size_t visibleFrom, size_t visibleTo) {
+    GetCurrentRegex();
+    size_t textSize = playgroundText.size();
+    size_t ws = patternCache.matchWindowStart, we = patternCache.matchWindowEnd;
+    bool covered = visibleFrom >= ws && visibleTo <= we &&
+                   (ws == 0 || visibleFrom >= ws + PLAYGROUND_MATCH_MARGIN / 2) &&
+                   (we >= textSize || visibleTo + PLAYGROUND_MATCH_MARGIN / 2 <= we);
+    if (patternCache.matchGraphRev == graphRevision && patternCache.matchTextRev == playgroundRevision &&
+        patternCache.matchDebugRev == debugRevision && covered) return;
+    ProfileScope scope(PROF_MATCH);
+    patternCache.matchGraphRev = graphRevision;
+    patternCache.matchTextRev = playgroundRevision;
+    patternCache.matchDebugRev = debugRevision;
+    ws = visibleFrom > PLAYGROUND_MATCH_MARGIN ? visibleFrom - PLAYGROUND_MATCH_MARGIN : 0;
+    we = std::min(textSize, visibleTo + PLAYGROUND_MATCH_MARGIN);
+    patternCache.matchWindowStart = ws;
+    patternCache.matchWindowEnd = we;
+
+    std::vector<HighlightSpan>& spans = patternCache.spans;
+    spans.clear();
+    patternCache.matchWarning.clear();
+    if (!patternCache.compiled) return;
+
+    if (isDebugging) {
+        if (currentDebugMatches.empty()) return;
+        const DebugMatch& dm = currentDebugMatches[currentDebugMatchIndex];
+        if (dm.length <= 0 || (size_t)dm.start >= we || (size_t)(dm.start + dm.length) <= ws) return;
+        // Groups paint over the match (later groups win), then the runs are emitted in order
+        std::vector<int> colors(dm.length, 1);
+        int gIdx = 0;
+        for (const auto& grp : dm.groups) {
+            int b = std::max(grp.start, dm.start), e = std::min(grp.start + grp.length, dm.start + dm.length);
+            for (int k = b; k < e; k++) colors[k - dm.start] = 2 + (gIdx % 3);
+            gIdx++;
+        }
+        for (int k = 0; k < dm.length; k++) {
+            if (!spans.empty() && spans.back().colorId == colors[k] && spans.back().start + spans.back().length == (size_t)(dm.start + k)) spans.back().length++;
+            else spans.push_back({ (size_t)(dm.start + k), 1, colors[k] });
+        }
+        return;
+    }
+
+    size_t context = ws > 0 ? 1 : 0; // one byte of look-behind for ^ and \b
+    try {
+        size_t len = we - ws + context;
+        const char* text = playgroundText.Contiguous(ws - context, len, patternCache.windowScratch);
+        patternCache.engine->ForEach(text, text + len, context, false, [&](const EngineMatch& match) {
+            if (match.length) spans.push_back({ ws - context + match.start, match.length, 1 });
+            return true;
+        });
+    } catch (const MatchBudgetExceeded& e) {
+        patternCache.matchWarning = FormatMatchAbort(e, ws - context); // keeps the spans found before the abort
+    } catch (...) {}
+}
+
+Color HighlightColor(int colorId) {
+    if (!isDebugging) return Fade(GREEN, 0.4f);
+    switch (colorId) {
+        case 2: return COL_GRP_1;
+        case 3: return COL_GRP_2;
+        case 4: return COL_GRP_3;
+        default: return COL_GRP_0;
+    }
+}
+
+// Restarts the background count when the pattern, engine or text changed
+void UpdatePlaygroundCount() {
+    const std::string& regex = GetCurrentRegex();
+    if (playgroundCount.graphRev == graphRevision && playgroundCount.textRev == playgroundRevision &&
+        playgroundCount.engine == currentEngine) return;
+    playgroundCount.graphRev = graphRevision;
+    playgroundCount.textRev = playgroundRevision;
+    playgroundCount.engine = currentEngine;
+    size_t stable = playgroundText.StableSince(playgroundCount.serial);
+    playgroundCount.serial = playgroundText.Serial();
+    std::string error;
+    playgroundCount.active = patternCache.compiled && playgroundCounter.Start(playgroundText, regex, currentEngine, stable, error);
+    if (!playgroundCount.active) playgroundCounter.Stop();
+}
+
+std::string FormatPlaygroundCount() {
+    if (!playgroundCount.active) return "";
+    if (playgroundCounter.Aborted()) return "count aborted";
+    if (!playgroundCounter.Finished()) return "counting " + std::to_string((int)(playgroundCounter.Progress() * 100)) + "%";
+    uint64_t n = playgroundCounter.Count();
+    return std::to_string(n) + (n == 1 ? " match" : " matches");
+}
+
+const float* GlyphAdvances(Font font, float fontSize) {
+    for (const auto& t : glyphTables) if (t.fontId == font.texture.id && t.fontSize == fontSize) return t.advance;
+    GlyphAdvanceTable t;
+    t.fontId = font.texture.id;
+    t.fontSize = fontSize;
+    t.advance[0] = 0;
+    for (int c = 1; c < 256; c++) {
+        char b[2] = { (char)c, '\0' };
+        t.advance[c] = MeasureTextEx(font, b, fontSize, 1.0f).x;
+    }
+    glyphTables.push_back(t);
+    return glyphTables.back().advance;
+}
+
+template <typename Fn>
+void ForEachTextSpan(const std::string& text, size_t from, size_t to, Fn fn) {
+    to = std::min(to, text.size());
+    if (from < to) fn(text.data() + from, to - from, from);
+}
+template <typename Fn>
+void ForEachTextSpan(const PieceTable& text, size_t from, size_t to, Fn fn) { text.ForEachSpan(from, to, fn); }
+
+size_t TextStablePrefix(const std::string&, size_t) { return 0; }
+size_t TextStablePrefix(const PieceTable& text, size_t revision) { return text.StableSince(revision); }
+
+// Same wrapping rule as before: a glyph that would cross maxWidth starts a new line.
+// For a PieceTable 'revision' is its edit serial, and an edit at the end only re-wraps from the
+// line that contains the first changed byte.
+template <typename Text>
+void LayoutText(TextLayout& layout, Font font, const Text& text, size_t revision, float fontSize, float maxWidth) {
+    bool sameGeometry = layout.fontId == font.texture.id && layout.fontSize == fontSize && layout.width == maxWidth;
+    if (sameGeometry && layout.revision == revision) return;
+    ProfileScope scope(PROF_LAYOUT);
+    size_t resumeAt = 0;
+    if (sameGeometry && layout.revision != (size_t)-1 && !layout.lineStarts.empty()) {
+        size_t stable = TextStablePrefix(text, layout.revision);
+        if (stable > 0) {
+            layout.lineStarts.erase(std::upper_bound(layout.lineStarts.begin(), layout.lineStarts.end(), stable - 1), layout.lineStarts.end());
+            resumeAt = layout.lineStarts.back();
         }
-        x += w;
     }
+    if (resumeAt == 0) layout.lineStarts.assign(1, 0);
+    layout.revision = revision;
+    layout.fontId = font.texture.id;
+    layout.fontSize = fontSize;
+    layout.width = maxWidth;
+    const float* adv = GlyphAdvances(font, fontSize);
+    float x = 0;
+    ForEachTextSpan(text, resumeAt, text.size(), [&](const char* data, size_t n, size_t offset) {
+        for (size_t j = 0; j < n; ++j) {
+            unsigned char c = (unsigned char)data[j];
+            if (c == '\n') { x = 0; layout.lineStarts.push_back(offset + j + 1); continue; }
+            if (x + adv[c] > maxWidth) { x = 0; layout.lineStarts.push_back(offset + j); }
+            x += adv[c];
+        }
+    });
+}
+
+// Line range intersecting [scrollOffset, scrollOffset + viewHeight)
+bool VisibleLines(const TextLayout& layout, float scrollOffset, float viewHeight, size_t& first, size_t& last) {
+    if (layout.lineStarts.empty() || layout.fontSize <= 0) return false;
+    first = (size_t)std::max(0.0f, std::floor(scrollOffset / layout.fontSize));
+    last = std::min(layout.lineStarts.size() - 1, (size_t)std::max(0.0f, (scrollOffset + viewHeight) / layout.fontSize));
+    return first <= last;
+}
+
+// Byte range [from, to) shown on the visible lines
+template <typename Text>
+void VisibleByteRange(const TextLayout& layout, const Text& text, float scrollOffset, float viewHeight, size_t& from, size_t& to) {
+    size_t first, last;
+    if (!VisibleLines(layout, scrollOffset, viewHeight, first, last)) { from = to = 0; return; }
+    from = layout.lineStarts[first];
+    to = (last + 1 < layout.lineStarts.size()) ? layout.lineStarts[last + 1] : text.size();
+}
+
+// Calls fn(index, char, x, y) for every glyph on the visible lines
+template <typename Text, typename Fn>
+void ForEachVisibleGlyph(const TextLayout& layout, Font font, const Text& text, float scrollOffset, float viewHeight, Fn fn) {
+    size_t first, last;
+    if (!VisibleLines(layout, scrollOffset, viewHeight, first, last)) return;
+    const float* adv = GlyphAdvances(font, layout.fontSize);
+    for (size_t line = first; line <= last; line++) {
+        size_t end = (line + 1 < layout.lineStarts.size()) ? layout.lineStarts[line + 1] : text.size();
+        float x = 0, y = line * layout.fontSize;
+        ForEachTextSpan(text, layout.lineStarts[line], end, [&](const char* data, size_t n, size_t offset) {
+            for (size_t j = 0; j < n; j++) {
+                char c = data[j];
+                if (c == '\n') return;
+                fn(offset + j, c, x, y);
+                x += adv[(unsigned char)c];
+            }
+        });
+    }
+}
+
+// Position just past the last glyph (text cursor at the end)
+template <typename Text>
+Vector2 LayoutEndPos(const TextLayout& layout, Font font, const Text& text) {
+    if (layout.lineStarts.empty()) return {0, 0};
+    const float* adv = GlyphAdvances(font, layout.fontSize);
+    float x = 0;
+    ForEachTextSpan(text, layout.lineStarts.back(), text.size(), [&](const char* data, size_t n, size_t) {
+        for (size_t j = 0; j < n; j++) x += adv[(unsigned char)data[j]];
+    });
+    return {x, (layout.lineStarts.size() - 1) * layout.fontSize};
+}
+
+// Updated DrawTextWrapped to handle scrollOffset (only the visible lines are emitted)
+void DrawTextWrapped(Font font, const std::string& text, const TextLayout& layout, Rectangle rec, Color color, float scrollOffset) {
+    ForEachVisibleGlyph(layout, font, text, scrollOffset, rec.height, [&](size_t, char c, float x, float y) {
+        char b[2] = { c, '\0' };
+        DrawTextEx(font, b, {rec.x + x, rec.y + y - scrollOffset}, layout.fontSize, 1.0f, color);
+    });
 }
 
 Vector2 GetTextPos(const std::string& text, size_t index, float fontSize) {
@@ -581,44 +1950,148 @@ Vector2 GetTextPos(const std::string& text, size_t index, float fontSize) {
     return {x, line * fontSize};
 }
 
-// UNDO / REDO IMPLEMENTATION (RESTORED)
+// UNDO / REDO IMPLEMENTATION (DELTA HISTORY)
+void RecordEdit(EditOp op) {
+    if (editOpen) pendingEdit.ops.push_back(std::move(op));
+}
+
+// Moves and value edits are captured when they begin and completed when the transaction closes
+void RecordMoveStart() {
+    for (const auto& n : nodes) if (n.selected) {
+        EditOp op; op.kind = EDIT_MOVE; op.nodeId = n.id; op.before = { n.rect.x, n.rect.y };
+        RecordEdit(op);
+    }
+}
+
+void RecordValueStart(const Node& n) {
+    EditOp op; op.kind = EDIT_SET_VALUE; op.nodeId = n.id; op.beforeTitle = n.title; op.beforeValue = n.regexValue;
+    RecordEdit(op);
+}
+
+void CloseEditTransaction() {
+    if (!editOpen) return;
+    editOpen = false;
+    EditTransaction t;
+    for (auto& op : pendingEdit.ops) {
+        const Node* n = FindNode(op.nodeId);
+        if (op.kind == EDIT_ADD_NODE) {
+            if (!n) continue;
+            op.node = *n; // final state, e.g. a template's custom value
+            op.node.isEditing = false;
+        } else if (op.kind == EDIT_MOVE) {
+            if (!n || (n->rect.x == op.before.x && n->rect.y == op.before.y)) continue;
+            op.after = { n->rect.x, n->rect.y };
+        } else if (op.kind == EDIT_SET_VALUE) {
+            if (!n || (n->title == op.beforeTitle && n->regexValue == op.beforeValue)) continue;
+            op.afterTitle = n->title; op.afterValue = n->regexValue;
+        }
+        t.bytes += sizeof(EditOp); // text lives in the string pool
+        t.ops.push_back(std::move(op));
+    }
+    pendingEdit = EditTransaction();
+    if (!t.ops.empty()) editHistory.Push(std::move(t)); // clicks and no-op edits leave no undo step
+}
+
 void SaveState() {
-    AppState state;
-    state.nodes = nodes;
-    state.connections = connections;
-    state.nextNodeId = nextNodeId;
-    undoStack.push_back(state);
-    if (undoStack.size() > 50) undoStack.erase(undoStack.begin());
-    redoStack.clear(); 
+    CloseEditTransaction();
+    editOpen = true;
+}
+
+void ClearEditHistory() {
+    editOpen = false;
+    pendingEdit = EditTransaction();
+    editHistory.Clear();
+}
+
+std::string FormatHistoryStats() {
+    return "Undo: " + std::to_string(editHistory.UndoCount()) + "/" + std::to_string(editHistory.Depth())
+         + " | Redo: " + std::to_string(editHistory.RedoCount()) + " | " + FormatBytes((double)editHistory.Bytes());
+}
+
+void UnlinkLastConnection() {
+    Connection c = connections.back();
+    connections.pop_back();
+    if (--graphIndex.incoming[c.toNodeId] == 0) graphIndex.incoming.erase(c.toNodeId);
+    if (--graphIndex.outgoing[c.fromNodeId] == 0) { graphIndex.outgoing.erase(c.fromNodeId); graphIndex.next.erase(c.fromNodeId); }
+    graphIndex.revision++;
+    graphRevision++;
+}
+
+// Appends and pops keep the index current in O(1); replaying a delete shifts slots and rebuilds it
+void ApplyEdit(const EditOp& op, bool forward, bool& rebuild) {
+    bool indexed = op.kind != EDIT_REMOVE_NODE && op.kind != EDIT_REMOVE_CONNECTION;
+    if (rebuild && indexed) { RebuildGraphIndex(); rebuild = false; } // a run of removals rebuilds once
+    switch (op.kind) {
+        case EDIT_ADD_NODE:
+            if (forward) {
+                nodes.push_back(op.node);
+                graphIndex.slot[op.node.id] = (int)nodes.size() - 1;
+                graphIndex.revision++;
+                graphRevision++;
+            } else if (!nodes.empty() && nodes.back().id == op.node.id) {
+                nodes.pop_back();
+                graphIndex.slot.erase(op.node.id);
+                graphIndex.revision++;
+                graphRevision++;
+            } else {
+                nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const Node& n) { return n.id == op.node.id; }), nodes.end());
+                rebuild = true;
+            }
+            break;
+        case EDIT_ADD_CONNECTION:
+            if (forward) LinkConnection(op.conn.fromNodeId, op.conn.toNodeId);
+            else if (!connections.empty() && connections.back().fromNodeId == op.conn.fromNodeId && connections.back().toNodeId == op.conn.toNodeId) UnlinkLastConnection();
+            else {
+                for (size_t i = connections.size(); i-- > 0;) {
+                    if (connections[i].fromNodeId == op.conn.fromNodeId && connections[i].toNodeId == op.conn.toNodeId) { connections.erase(connections.begin() + i); break; }
+                }
+                rebuild = true;
+            }
+            break;
+        case EDIT_REMOVE_NODE:
+            if (forward) nodes.erase(nodes.begin() + op.index);
+            else nodes.insert(nodes.begin() + op.index, op.node);
+            rebuild = true;
+            break;
+        case EDIT_REMOVE_CONNECTION:
+            if (forward) connections.erase(connections.begin() + op.index);
+            else connections.insert(connections.begin() + op.index, op.conn);
+            rebuild = true;
+            break;
+        case EDIT_MOVE:
+            if (Node* n = FindNode(op.nodeId)) {
+                Vector2 p = forward ? op.after : op.before;
+                n->rect.x = p.x; n->rect.y = p.y;
+                NodeMoved(*n);
+            }
+            break;
+        case EDIT_SET_VALUE:
+            if (Node* n = FindNode(op.nodeId)) {
+                n->title = forward ? op.afterTitle : op.beforeTitle;
+                n->regexValue = forward ? op.afterValue : op.beforeValue;
+                UpdateRegexSegment(n->id);
+            }
+            break;
+    }
 }
 
 void Undo() {
-    if (undoStack.empty()) return;
-    AppState current;
-    current.nodes = nodes;
-    current.connections = connections;
-    current.nextNodeId = nextNodeId;
-    redoStack.push_back(current);
-    AppState prev = undoStack.back();
-    undoStack.pop_back();
-    nodes = prev.nodes;
-    connections = prev.connections;
-    nextNodeId = prev.nextNodeId;
+    CloseEditTransaction();
+    EditTransaction* t = editHistory.PopUndo();
+    if (!t) return;
+    bool rebuild = false;
+    for (size_t i = t->ops.size(); i-- > 0;) ApplyEdit(t->ops[i], false, rebuild);
+    if (rebuild) RebuildGraphIndex();
     AddLog("[UNDO]");
 }
 
 void Redo() {
-    if (redoStack.empty()) return;
-    AppState current;
-    current.nodes = nodes;
-    current.connections = connections;
-    current.nextNodeId = nextNodeId;
-    undoStack.push_back(current);
-    AppState next = redoStack.back();
-    redoStack.pop_back();
-    nodes = next.nodes;
-    connections = next.connections;
-    nextNodeId = next.nextNodeId;
+    CloseEditTransaction();
+    EditTransaction* t = editHistory.PopRedo();
+    if (!t) return;
+    bool rebuild = false;
+    for (const auto& op : t->ops) ApplyEdit(op, true, rebuild);
+    if (rebuild) RebuildGraphIndex();
     AddLog("[REDO]");
 }
 
@@ -651,6 +2124,16 @@ std::string GetExportCode(std::string regex, ExportLang lang) {
                 else out += c;
             }
             return "Pattern pattern = Pattern.compile(\"" + out + "\");";
+        case LANG_CPP_NATIVE: {
+            if (nativeExport.valid && nativeExport.pattern == regex) return nativeExport.code;
+            std::string error;
+            nativeExport.pattern = regex;
+            nativeExport.valid = true;
+            if (!GenerateNativeMatcher(regex, "regex_studio_matcher", nativeExport.code, error)) {
+                nativeExport.code = "// Native matcher unavailable: " + error + "\n// (dfa subset only: no backreferences, lookaround or \\b)";
+            }
+            return nativeExport.code;
+        }
     }
     return regex;
 }
@@ -698,15 +2181,17 @@ void PasteFromClipboard(Vector2 pastePos) {
         newNode.rect.x = pastePos.x + relPos.x;
         newNode.rect.y = pastePos.y + relPos.y;
         nodes.push_back(newNode);
+        graphIndex.slot[newNode.id] = (int)nodes.size() - 1;
+        graphIndex.revision++;
+        EditOp op; op.kind = EDIT_ADD_NODE; op.nodeId = newNode.id;
+        RecordEdit(op);
         idMap[clipNode.id] = newNode.id;
     }
 
     for (const auto& clipConn : clipboard.connections) {
-        Connection newConn;
-        newConn.fromNodeId = idMap[clipConn.fromNodeId];
-        newConn.toNodeId = idMap[clipConn.toNodeId];
-        connections.push_back(newConn);
+        AddConnection(idMap[clipConn.fromNodeId], idMap[clipConn.toNodeId]);
     }
+    graphRevision++;
     AddLog("[CLIPBOARD] Pasted.");
 }
 
@@ -714,24 +2199,212 @@ void DeleteSelected() {
     if (nodes.empty() && connections.empty()) return;
     SaveState(); // UNDO POINT
 
-    for (int i = connections.size() - 1; i >= 0; i--) {
-        bool fromSel = false, toSel = false;
-        for (const auto& n : nodes) {
-            if (n.id == connections[i].fromNodeId && n.selected) fromSel = true;
-            if (n.id == connections[i].toNodeId && n.selected) toSel = true;
+    // Single compaction pass over each vector instead of repeated erase + node scans.
+    // Removals are recorded back to front so undo can reinsert them at their original slots.
+    auto isSelected = [](int id) { const Node* n = FindNode(id); return n && n->selected; };
+    for (size_t i = connections.size(); i-- > 0;) {
+        if (!isSelected(connections[i].fromNodeId) && !isSelected(connections[i].toNodeId)) continue;
+        EditOp op; op.kind = EDIT_REMOVE_CONNECTION; op.index = (int)i; op.conn = connections[i];
+        RecordEdit(op);
+    }
+    for (size_t i = nodes.size(); i-- > 0;) {
+        if (!nodes[i].selected) continue;
+        EditOp op; op.kind = EDIT_REMOVE_NODE; op.index = (int)i; op.node = nodes[i]; op.nodeId = nodes[i].id;
+        RecordEdit(op);
+    }
+    connections.erase(std::remove_if(connections.begin(), connections.end(), [&](const Connection& c) {
+        return isSelected(c.fromNodeId) || isSelected(c.toNodeId);
+    }), connections.end());
+    nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [](const Node& n) { return n.selected; }), nodes.end());
+    RebuildGraphIndex();
+}
+
+// ----------------------------------------------------------------------------------
+// Headless Mode
+// ----------------------------------------------------------------------------------
+
+const char* HEADLESS_USAGE =
+    "usage: regexstudio --project <file.vreg> [--scan <path>] [--threads <n>] [--engine std|dfa|auto]\n"
+    "                   [--stream] [--lines] [--max <n>] [--json]\n"
+    "                   [--include <globs>] [--exclude <globs>] [--max-size <n[k|m|g]>] [--gitignore] [--all]\n"
+    "                   [--cache <file>]   (re-scans only read files that changed; appended logs resume)\n"
+    "                   [--trace <file.json>]   (Chrome trace of the scan: chrome://tracing or ui.perfetto.dev)\n"
+    "Without --scan the generated regex is printed. Exit status: 0 = matches, 1 = none, 2 = error.\n"
+    "Repeat --project (or pass a directory) to scan a pattern set; every file is read once.\n";
+
+// 'name' is the pattern of a set scan; empty for a single pattern
+void PrintHeadlessHit(const ScanHit& hit, const std::string& name, bool json, bool& firstHit) {
+    if (json) {
+        printf("%s\n    { \"path\": %s", firstHit ? "" : ",", JsonString(hit.path).c_str());
+        if (!name.empty()) printf(", \"pattern\": %s", JsonString(name).c_str());
+        firstHit = false;
+        if (!hit.warning.empty()) { printf(", \"warning\": %s }", JsonString(hit.warning).c_str()); return; }
+        printf(", \"count\": %zu", hit.count);
+        if (!hit.locations.empty()) {
+            printf(", \"locations\": [");
+            for (size_t k = 0; k < hit.locations.size(); k++) {
+                const ScanLocation& loc = hit.locations[k];
+                printf("%s{ \"line\": %llu, \"column\": %llu, \"text\": %s }", k ? ", " : "",
+                       (unsigned long long)loc.line, (unsigned long long)loc.column, JsonString(loc.text).c_str());
+            }
+            printf("]");
+        }
+        printf(" }");
+        return;
+    }
+    std::string label = name.empty() ? "" : "[" + name + "] ";
+    if (!hit.warning.empty()) { fprintf(stderr, "[WARN] %s%s: %s\n", label.c_str(), hit.path.c_str(), hit.warning.c_str()); return; }
+    if (hit.locations.empty()) printf("%s%s:%zu\n", label.c_str(), hit.path.c_str(), hit.count);
+    for (const auto& loc : hit.locations) {
+        printf("%s%s:%llu:%llu: %s\n", label.c_str(), hit.path.c_str(), (unsigned long long)loc.line, (unsigned long long)loc.column, loc.text.c_str());
+    }
+}
+
+// Loads a project and optionally scans with it, without touching raylib or the GPU
+int RunHeadless(int argc, char** argv) {
+    headlessMode = true;
+    std::vector<std::string> projectPaths;
+    std::string scanPath, tracePath;
+    ScanOptions opts;
+    opts.engine = ENGINE_AUTO;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--project" && hasValue) projectPaths.push_back(argv[++i]);
+        else if (arg == "--scan" && hasValue) scanPath = argv[++i];
+        else if (arg == "--threads" && hasValue) opts.threads = (unsigned)std::max(0, atoi(argv[++i]));
+        else if (arg == "--max" && hasValue) opts.maxLocations = (size_t)std::max(1, atoi(argv[++i]));
+        else if (arg == "--engine" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "std") opts.engine = ENGINE_STD;
+            else if (name == "dfa") opts.engine = ENGINE_DFA;
+            else if (name != "auto") { fprintf(stderr, "%s", HEADLESS_USAGE); return 2; }
+        }
+        else if ((arg == "--include" || arg == "--exclude") && hasValue) AddGlobs(arg == "--include" ? opts.include : opts.exclude, argv[++i]);
+        else if (arg == "--max-size" && hasValue) {
+            if (!ParseByteSize(argv[++i], opts.maxFileSize)) { fprintf(stderr, "bad size: %s\n%s", argv[i], HEADLESS_USAGE); return 2; }
         }
-        if (fromSel || toSel) connections.erase(connections.begin() + i);
+        else if (arg == "--gitignore") opts.gitignore = true;
+        else if (arg == "--all") { opts.skipBinary = false; opts.skipVcs = false; }
+        else if (arg == "--cache" && hasValue) opts.cachePath = argv[++i];
+        else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+        else if (arg == "--stream") opts.stream = true;
+        else if (arg == "--lines") opts.lines = true;
+        else if (arg == "--json") json = true;
+        else if (arg == "--help" || arg == "-h") { printf("%s", HEADLESS_USAGE); return 0; }
+        else { fprintf(stderr, "unknown argument: %s\n%s", arg.c_str(), HEADLESS_USAGE); return 2; }
+    }
+    if (projectPaths.empty()) { fprintf(stderr, "%s", HEADLESS_USAGE); return 2; }
+    std::error_code ec;
+    bool isSet = projectPaths.size() > 1 || std::filesystem::is_directory(projectPaths[0], ec);
+    if (isSet) {
+        std::string list, error;
+        for (const auto& path : projectPaths) list += (list.empty() ? "" : ",") + path;
+        if (!CollectProjectPatterns(list, opts, error)) { AddLog("[ERROR] " + error); return 2; }
+    } else {
+        if (!LoadProject(projectPaths[0])) return 2;
+        opts.pattern = GenerateRegex();
+        if (opts.pattern.empty()) { AddLog("[ERROR] Empty Regex (the project has no connected nodes)."); return 2; }
     }
-    for (int i = nodes.size() - 1; i >= 0; i--) {
-        if (nodes[i].selected) nodes.erase(nodes.begin() + i);
+    if (scanPath.empty()) {
+        if (!isSet) {
+            if (json) printf("{ \"pattern\": %s }\n", JsonString(opts.pattern).c_str());
+            else printf("%s\n", opts.pattern.c_str());
+            return 0;
+        }
+        if (json) printf("{ \"patterns\": {");
+        for (size_t p = 0; p < opts.patterns.size(); p++) {
+            if (json) printf("%s %s: %s", p ? "," : "", JsonString(opts.patternNames[p]).c_str(), JsonString(opts.patterns[p]).c_str());
+            else printf("%s\t%s\n", opts.patternNames[p].c_str(), opts.patterns[p].c_str());
+        }
+        if (json) printf(" } }\n");
+        return 0;
+    }
+    if (!std::filesystem::exists(scanPath, ec)) { AddLog("[ERROR] Path not found: " + scanPath); return 2; }
+
+    FileScanner scanner;
+    std::string error;
+    if (!tracePath.empty()) profiler.StartTrace();
+    if (!scanner.Start(scanPath, opts, error)) { AddLog("[ERROR] Regex Engine: " + error); return 2; }
+    if (json && isSet) printf("{\n  \"hits\": [");
+    else if (json) printf("{\n  \"pattern\": %s,\n  \"hits\": [", JsonString(opts.pattern).c_str());
+
+    std::vector<ScanHit> hits;
+    bool firstHit = true;
+    auto drain = [&]() {
+        scanner.results.Drain(hits);
+        for (const auto& hit : hits) PrintHeadlessHit(hit, (isSet && hit.pattern >= 0) ? scanner.PatternName(hit.pattern) : "", json, firstHit);
+        hits.clear();
+    };
+    while (!scanner.finished) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    scanner.Wait();
+    drain();
+    if (!scanner.cacheStatus.empty()) AddLog("[WARN] Scan cache: " + scanner.cacheStatus);
+    if (!tracePath.empty()) {
+        std::vector<TraceEvent> events;
+        bool truncated = false;
+        profiler.StopTrace(events, truncated);
+        if (!WriteChromeTrace(tracePath, events)) AddLog("[ERROR] Could not write " + tracePath);
+        else if (truncated) AddLog("[WARN] Trace stopped at " + std::to_string(TRACE_MAX_EVENTS) + " events.");
+    }
+
+    double elapsed = scanner.ElapsedSeconds();
+    if (json) {
+        printf("\n  ],");
+        if (isSet) {
+            printf("\n  \"patterns\": {");
+            for (size_t p = 0; p < scanner.PatternCount(); p++) {
+                printf("%s %s: %llu", p ? "," : "", JsonString(scanner.PatternName(p)).c_str(), (unsigned long long)scanner.patternMatches[p].load());
+            }
+            printf(" },");
+        }
+        printf("\n  \"files_scanned\": %llu,\n  \"bytes_scanned\": %llu,\n  \"matches\": %llu,\n  \"files_aborted\": %llu,\n"
+               "  \"files_unreadable\": %llu,\n  \"files_filtered\": %llu,\n  \"files_binary\": %llu,\n  \"dirs_pruned\": %llu,\n"
+               "  \"archives\": %llu,\n  \"bytes_decompressed\": %llu,\n  \"files_cached\": %llu,\n  \"files_resumed\": %llu,\n"
+               "  \"bytes_reused\": %llu,\n  \"elapsed_s\": %.3f\n}\n",
+               (unsigned long long)scanner.filesScanned.load(), (unsigned long long)scanner.bytesScanned.load(),
+               (unsigned long long)scanner.totalMatches.load(), (unsigned long long)scanner.filesAborted.load(),
+               (unsigned long long)scanner.filesUnreadable.load(), (unsigned long long)scanner.filesFiltered.load(),
+               (unsigned long long)scanner.filesBinary.load(), (unsigned long long)scanner.dirsPruned.load(),
+               (unsigned long long)scanner.archivesScanned.load(), (unsigned long long)scanner.bytesInflated.load(),
+               (unsigned long long)scanner.filesCached.load(), (unsigned long long)scanner.filesResumed.load(),
+               (unsigned long long)scanner.bytesReused.load(), elapsed);
+    } else {
+        fprintf(stderr, "[DONE] Scanned %llu files (%s, %.2fs). Matches: %llu\n", (unsigned long long)scanner.filesScanned.load(),
+                FormatBytes((double)scanner.bytesScanned.load()).c_str(), elapsed, (unsigned long long)scanner.totalMatches.load());
+        if (scanner.filesUnreadable) fprintf(stderr, "Unreadable: %llu file(s)\n", (unsigned long long)scanner.filesUnreadable.load());
+        if (scanner.filesFiltered || scanner.filesBinary || scanner.dirsPruned) {
+            fprintf(stderr, "Skipped: %llu filtered, %llu binary, %llu dir(s) pruned\n", (unsigned long long)scanner.filesFiltered.load(),
+                    (unsigned long long)scanner.filesBinary.load(), (unsigned long long)scanner.dirsPruned.load());
+        }
+        if (scanner.filesCached || scanner.filesResumed) {
+            fprintf(stderr, "Cache: %llu unchanged, %llu resumed, %s not re-read\n", (unsigned long long)scanner.filesCached.load(),
+                    (unsigned long long)scanner.filesResumed.load(), FormatBytes((double)scanner.bytesReused.load()).c_str());
+        }
+        if (scanner.archivesScanned) {
+            fprintf(stderr, "Archives: %llu (%s decompressed)\n", (unsigned long long)scanner.archivesScanned.load(),
+                    FormatBytes((double)scanner.bytesInflated.load()).c_str());
+        }
+        if (isSet) {
+            for (size_t p = 0; p < scanner.PatternCount(); p++) {
+                fprintf(stderr, "  %s: %llu\n", scanner.PatternName(p).c_str(), (unsigned long long)scanner.patternMatches[p].load());
+            }
+        }
     }
+    return scanner.totalMatches ? 0 : 1;
 }
 
 // ----------------------------------------------------------------------------------
 // Main
 // ----------------------------------------------------------------------------------
 
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) return RunHeadless(argc, argv);
+
     const int screenWidth = 1280;
     const int screenHeight = 900;
     SetConfigFlags(FLAG_MSAA_4X_HINT | FLAG_WINDOW_RESIZABLE); 
@@ -745,14 +2418,18 @@ int main() {
     AddNode(NODE_START, 100, 300);
     
     int editingNodeId = -1;
+    std::string editingValue; // text of the node being edited, interned when the edit ends
     float copyFeedbackTimer = 0.0f;
     AddLog("Ready. Type 'save <name>' or 'load <name>' in terminal.");
 
     SetExitKey(KEY_NULL);
 
     while (!WindowShouldClose()) {
+        profiler.BeginFrame();
         float dt = GetFrameTime();
         if (copyFeedbackTimer > 0) copyFeedbackTimer -= dt;
+        PumpScanResults();
+        PumpBenchResults();
         cursorBlinkTimer += dt;
 
         int curW = GetScreenWidth(); int curH = GetScreenHeight(); // DYNAMIC SIZE
@@ -762,7 +2439,7 @@ int main() {
         int key = GetCharPressed(); 
         bool inputConsumed = false;
 
-        auto HandleBackspace = [&](std::string& target) {
+        auto HandleBackspace = [&](auto& target) {
             if (IsKeyPressed(KEY_BACKSPACE)) {
                 if (!target.empty()) target.pop_back();
                 keyRepeatTimer = KEY_REPEAT_DELAY; 
@@ -779,6 +2456,7 @@ int main() {
         bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
         if (ctrl && IsKeyPressed(KEY_Z)) Undo();
         if (ctrl && (IsKeyPressed(KEY_Y) || (IsKeyDown(KEY_LEFT_SHIFT) && IsKeyPressed(KEY_Z)))) Redo();
+        if (IsKeyPressed(KEY_F3)) showProfiler = !showProfiler;
 
         // 1. OVERLAYS (Help/FullView)
         if (showHelp || showFullRegex || showTemplates) {
@@ -827,49 +2505,59 @@ int main() {
             if (ctrl && IsKeyPressed(KEY_V)) {
                 const char* clip = GetClipboardText();
                 if (clip) playgroundText += std::string(clip);
-                if (isDebugging) AnalyzeMatchesForDebug(GenerateRegex()); 
+                playgroundRevision++;
+                if (isDebugging) AnalyzeMatchesForDebug(); 
             }
             while (key > 0) {
-                if ((key >= 32) && (key <= 125)) playgroundText += (char)key;
+                if ((key >= 32) && (key <= 125)) { playgroundText += (char)key; playgroundRevision++; }
                 key = GetCharPressed();
-                if (isDebugging) AnalyzeMatchesForDebug(GenerateRegex());
+                if (isDebugging) AnalyzeMatchesForDebug();
             }
             if (IsKeyPressed(KEY_BACKSPACE) || IsKeyDown(KEY_BACKSPACE)) {
+               size_t lenBefore = playgroundText.length();
                HandleBackspace(playgroundText);
-               if (isDebugging) AnalyzeMatchesForDebug(GenerateRegex());
+               if (playgroundText.length() != lenBefore) {
+                   playgroundRevision++;
+                   if (isDebugging) AnalyzeMatchesForDebug();
+               }
             }
-            if (IsKeyPressed(KEY_ENTER)) { playgroundText += '\n'; if (isDebugging) AnalyzeMatchesForDebug(GenerateRegex()); }
+            if (IsKeyPressed(KEY_ENTER)) { playgroundText += '\n'; playgroundRevision++; if (isDebugging) AnalyzeMatchesForDebug(); }
             inputConsumed = true; 
         }
 
         // 4. NODE EDITING
         if (!inputConsumed && editingNodeId != -1) {
-            if (IsKeyPressed(KEY_ENTER) || (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !CheckCollisionPointRec(mouseWorld, nodes[0].rect))) { 
+            Node* edited = FindNode(editingNodeId);
+            if (!edited || IsKeyPressed(KEY_ENTER) || (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !CheckCollisionPointRec(mouseWorld, edited->rect))) { 
+                if (edited) {
+                    edited->regexValue = editingValue;
+                    if (edited->type == NODE_CUSTOM) edited->title = edited->regexValue;
+                    UpdateRegexSegment(edited->id);
+                    edited->isEditing = false;
+                }
                 SaveState(); // UNDO POINT: Finish Edit
                 editingNodeId = -1;
-                for(auto& n : nodes) n.isEditing = false;
             } else {
+                Node& n = *edited;
                 while (key > 0) {
                     if ((key >= 32) && (key <= 125)) {
-                        for(auto& n : nodes) if (n.id == editingNodeId) {
-                            n.regexValue += (char)key;
-                            if(n.type == NODE_CUSTOM) n.title = n.regexValue; 
-                        }
+                        editingValue += (char)key;
+                        UpdateRegexSegment(n.id, editingValue);
                     }
                     key = GetCharPressed();
                 }
                 if (IsKeyPressed(KEY_BACKSPACE)) {
-                    for(auto& n : nodes) if (n.id == editingNodeId && !n.regexValue.empty()) {
-                        n.regexValue.pop_back();
-                        if(n.type == NODE_CUSTOM) n.title = n.regexValue;
+                    if (!editingValue.empty()) {
+                        editingValue.pop_back();
+                        UpdateRegexSegment(n.id, editingValue);
                     }
                     keyRepeatTimer = KEY_REPEAT_DELAY;
                 } else if (IsKeyDown(KEY_BACKSPACE)) {
                     keyRepeatTimer -= dt;
                     if (keyRepeatTimer <= 0) {
-                        for(auto& n : nodes) if (n.id == editingNodeId && !n.regexValue.empty()) {
-                            n.regexValue.pop_back();
-                            if(n.type == NODE_CUSTOM) n.title = n.regexValue;
+                        if (!editingValue.empty()) {
+                            editingValue.pop_back();
+                            UpdateRegexSegment(n.id, editingValue);
                         }
                         keyRepeatTimer = KEY_REPEAT_RATE;
                     }
@@ -905,26 +2593,24 @@ int main() {
             // MOUSE LEFT CLICK LOGIC (Selection & Drag)
             if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && mouseScreen.y > 80 && mouseScreen.y < curH - 210) { // Check zones with dynamic height
                 bool clickedNode = false;
-                for (int i = nodes.size() - 1; i >= 0; i--) {
-                    if (CheckCollisionPointRec(mouseWorld, nodes[i].rect)) {
-                        clickedNode = true;
-                        bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
-                        if (shift) {
-                            nodes[i].selected = !nodes[i].selected;
-                        } else {
-                            if (!nodes[i].selected) {
-                                for (auto& n : nodes) n.selected = false;
-                                nodes[i].selected = true;
-                            }
+                if (Node* hit = NodeAt(mouseWorld)) {
+                    clickedNode = true;
+                    bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+                    if (shift) {
+                        hit->selected = !hit->selected;
+                    } else {
+                        if (!hit->selected) {
+                            for (auto& n : nodes) n.selected = false;
+                            hit->selected = true;
                         }
-                        isDraggingNodes = true;
-                        SaveState(); // UNDO POINT: Start Drag
-                        for (auto& n : nodes) {
-                            if (n.selected) {
-                                n.dragOffset = { mouseWorld.x - n.rect.x, mouseWorld.y - n.rect.y };
-                            }
+                    }
+                    isDraggingNodes = true;
+                    SaveState(); // UNDO POINT: Start Drag
+                    RecordMoveStart();
+                    for (auto& n : nodes) {
+                        if (n.selected) {
+                            n.dragOffset = { mouseWorld.x - n.rect.x, mouseWorld.y - n.rect.y };
                         }
-                        break;
                     }
                 }
 
@@ -942,6 +2628,7 @@ int main() {
                     if (n.selected) {
                         n.rect.x = mouseWorld.x - n.dragOffset.x;
                         n.rect.y = mouseWorld.y - n.dragOffset.y;
+                        NodeMoved(n);
                     }
                 }
             } else {
@@ -957,7 +2644,10 @@ int main() {
                     float w = std::abs(mouseWorld.x - boxSelectionStart.x);
                     float h = std::abs(mouseWorld.y - boxSelectionStart.y);
                     Rectangle selRect = {x,y,w,h};
-                    for (auto& n : nodes) if (CheckCollisionRecs(selRect, n.rect)) n.selected = true;
+                    static std::vector<int> inBox;
+                    SyncSpatialGrid();
+                    spatialGrid.Query(selRect, inBox);
+                    for (int slot : inBox) if (CheckCollisionRecs(selRect, nodes[slot].rect)) nodes[slot].selected = true;
                 }
             }
 
@@ -967,6 +2657,8 @@ int main() {
                     if (n.selected) {
                         editingNodeId = n.id;
                         SaveState(); // UNDO POINT: Before Edit
+                        RecordValueStart(n);
+                        editingValue = n.regexValue.str();
                         n.isEditing = true;
                         break; 
                     }
@@ -975,46 +2667,60 @@ int main() {
 
             // CONNECTIONS
             if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) {
-                for (const auto& n : nodes) if (CheckCollisionPointRec(mouseWorld, n.rect)) { isCreatingConnection = true; connectionStartNodeId = n.id; break; }
+                if (const Node* n = NodeAt(mouseWorld)) { isCreatingConnection = true; connectionStartNodeId = n->id; }
             }
             if (IsMouseButtonReleased(MOUSE_RIGHT_BUTTON) && isCreatingConnection) {
                 isCreatingConnection = false;
-                for (const auto& n : nodes) if (CheckCollisionPointRec(mouseWorld, n.rect) && n.id != connectionStartNodeId) {
+                const Node* n = NodeAt(mouseWorld);
+                if (n && n->id != connectionStartNodeId) {
                     SaveState(); // UNDO POINT: New Connection
-                    connections.push_back({connectionStartNodeId, n.id}); break;
+                    AddConnection(connectionStartNodeId, n->id);
                 }
             }
         }
 
         // --- DRAW ---
         BeginDrawing();
+        std::optional<ProfileScope> drawScope; // ends before EndDrawing so the vsync wait stays out of the draw zone
+        drawScope.emplace(PROF_DRAW);
         ClearBackground(COL_BG);
 
         BeginMode2D(camera);
             DrawGrid2D(100, 40.0f);
             
-            for (const auto& conn : connections) {
-                Vector2 s, e;
-                for (const auto& n : nodes) {
-                    if (n.id == conn.fromNodeId) s = { n.rect.x + n.rect.width, n.rect.y + n.rect.height/2 };
-                    if (n.id == conn.toNodeId) e = { n.rect.x, n.rect.y + n.rect.height/2 };
-                }
-                DrawLineBezier(s, e, 3.0f, COL_WIRE);
-            }
+            // VIEWPORT CULLING: only wires and nodes that can reach the screen are drawn
+            Rectangle view = VisibleWorldRect(curW, curH, 16.0f);
+            canvasStats = CanvasStats();
+            DrawWires(view, 3.0f, COL_WIRE);
             if (isCreatingConnection) {
-                Vector2 s;
-                for (const auto& n : nodes) if (n.id == connectionStartNodeId) s = { n.rect.x + n.rect.width, n.rect.y + n.rect.height/2 };
-                DrawLineBezier(s, mouseWorld, 3.0f, COL_WIRE_ACTIVE);
+                if (const Node* from = FindNode(connectionStartNodeId)) {
+                    Vector2 s = { from->rect.x + from->rect.width, from->rect.y + from->rect.height/2 };
+                    DrawLineBezier(s, mouseWorld, 3.0f, COL_WIRE_ACTIVE);
+                }
             }
 
-            for (const auto& n : nodes) {
+            GetCurrentRegex(); // refreshes the complexity tint before the nodes are drawn
+            static std::vector<int> visible;
+            SyncSpatialGrid();
+            spatialGrid.Query(view, visible);
+            for (int slot : visible) {
+                const Node& n = nodes[slot];
+                if (!CheckCollisionRecs(n.rect, view)) continue;
+                canvasStats.nodesDrawn++;
                 DrawRectangleRounded(n.rect, 0.2f, 8, n.isEditing ? RED : n.color);
+                auto risk = patternCache.riskNodes.find(n.id);
+                if (risk != patternCache.riskNodes.end()) {
+                    Color tint = RiskColor(risk->second);
+                    DrawRectangleRounded(n.rect, 0.2f, 8, Fade(tint, 0.45f));
+                    for (float grow = 3; grow <= 6; grow += 1.5f) {
+                        DrawRectangleRoundedLines({n.rect.x - grow, n.rect.y - grow, n.rect.width + grow * 2, n.rect.height + grow * 2}, 0.2f, 8, tint);
+                    }
+                }
                 if (n.selected) DrawRectangleRoundedLines(n.rect, 0.2f, 8, WHITE);
                 else DrawRectangleRoundedLines(n.rect, 0.2f, 8, BLACK);
                 
-                std::string displayStr = n.title;
-                if (n.isEditing && n.type != NODE_CUSTOM) displayStr = n.regexValue;
-                DrawTextEx(mainFont, displayStr.c_str(), {n.rect.x + 10, n.rect.y + 20}, 18, 1.0f, BLACK);
+                const char* displayStr = n.isEditing ? editingValue.c_str() : n.title.c_str();
+                DrawTextEx(mainFont, displayStr, {n.rect.x + 10, n.rect.y + 20}, 18, 1.0f, BLACK);
             }
 
             if (isBoxSelecting) {
@@ -1030,7 +2736,7 @@ int main() {
 
         // UI HEADERS
         DrawRectangle(0, 0, curW, 80, Fade(BLACK, 0.9f));
-        std::string regStr = GenerateRegex();
+        std::string regStr = GetCurrentRegex();
         DrawTextEx(mainFont, "REGEX:", {20, 30}, 20, 1.0f, LIGHTGRAY);
         
         float textStartX = 100;
@@ -1044,6 +2750,10 @@ int main() {
         }
         BeginScissorMode((int)textStartX, 0, (int)availableWidth, 80);
             DrawTextEx(mainFont, regStr.c_str(), {textStartX, 25}, fontSize, 1.0f, YELLOW);
+            if (!patternCache.risk.findings.empty()) {
+                std::string riskStr = "ReDoS risk: " + patternCache.risk.Complexity() + " - " + patternCache.risk.findings[0].reason;
+                DrawTextEx(mainFont, riskStr.c_str(), {textStartX, 60}, 14, 1.0f, RiskColor(patternCache.risk.level));
+            }
         EndScissorMode();
         
         // --- BUTTONS ---
@@ -1056,7 +2766,7 @@ int main() {
         if (!showConsole) {
             if (GuiButton({btnX, 20, 100, 40}, showPlayground ? "HIDE" : "TEST")) {
                 showPlayground = !showPlayground;
-                if (showPlayground) isDebugging = false; 
+                if (showPlayground) { isDebugging = false; debugRevision++; }
             }
         } else {
             DrawRectangleRec({btnX, 20, 100, 40}, Fade(GRAY, 0.5f));
@@ -1082,23 +2792,28 @@ int main() {
             // Header
             DrawRectangle(playgroundRect.x, playgroundRect.y, playgroundRect.width, 40, Fade(BLUE, 0.2f));
             DrawTextEx(mainFont, isDebugging ? "MATCH DEBUGGER" : "PLAYGROUND", {playgroundRect.x + 20, playgroundRect.y + 10}, 18, 1.0f, BLUE);
+            UpdatePlaygroundCount();
+            DrawTextEx(mainFont, FormatPlaygroundCount().c_str(), {playgroundRect.x + (isDebugging ? 175 : 135), playgroundRect.y + 12}, 14, 1.0f, GRAY);
             
             // NEW: ERASE BUTTON
             if (GuiButton({playgroundRect.x + playgroundRect.width - 190, playgroundRect.y + 5, 80, 30}, "ERASE")) {
-                playgroundText = "";
-                if (isDebugging) AnalyzeMatchesForDebug(regStr);
+                playgroundText.Assign("");
+                playgroundRevision++;
+                if (isDebugging) AnalyzeMatchesForDebug();
             }
             
             if (GuiButton({playgroundRect.x + playgroundRect.width - 100, playgroundRect.y + 5, 80, 30}, isDebugging ? "EXIT" : "DEBUG")) {
                 isDebugging = !isDebugging;
-                if (isDebugging) AnalyzeMatchesForDebug(regStr);
+                debugRevision++;
+                if (isDebugging) AnalyzeMatchesForDebug();
             }
 
             float fontSize = 20.0f;
             Rectangle textArea = { playgroundRect.x + 10, playgroundRect.y + 50, playgroundRect.width - 35, playgroundRect.height - 60 };
             if (isDebugging) textArea.height -= 100; 
 
-            float totalHeight = CalculateWrappedHeight(playgroundText, fontSize, textArea.width);
+            LayoutText(playgroundLayout, mainFont, playgroundText, (size_t)playgroundText.Serial(), fontSize, textArea.width);
+            float totalHeight = playgroundLayout.Height();
             float maxScroll = std::max(0.0f, totalHeight - textArea.height);
             
             if (mouseOverPlayground) {
@@ -1131,81 +2846,61 @@ int main() {
             } else playgroundScrollOffset = 0;
 
             BeginScissorMode((int)textArea.x, (int)textArea.y, (int)textArea.width, (int)textArea.height);
-                std::vector<bool> isMatched(playgroundText.length(), false);
-                std::vector<int> matchColors(playgroundText.length(), 0);
-                
-                if (!regStr.empty()) {
-                    try {
-                        std::regex pattern(regStr);
-                        auto wb = std::sregex_iterator(playgroundText.begin(), playgroundText.end(), pattern);
-                        auto we = std::sregex_iterator();
-                        for (auto i = wb; i != we; ++i) {
-                            std::smatch match = *i;
-                            if (isDebugging) {
-                                if (currentDebugMatches.empty()) continue;
-                                DebugMatch& dm = currentDebugMatches[currentDebugMatchIndex];
-                                if (match.position() == dm.start) {
-                                    for (int k = 0; k < match.length(); k++) {
-                                        isMatched[match.position() + k] = true;
-                                        matchColors[match.position() + k] = 1;
-                                    }
-                                    int gIdx = 0;
-                                    for (auto& grp : dm.groups) {
-                                        int gColorID = 2 + (gIdx % 3);
-                                        for (int k = 0; k < grp.length; k++) matchColors[grp.start + k] = gColorID;
-                                        gIdx++;
-                                    }
-                                }
-                            } else {
-                                for (int k = 0; k < match.length(); k++) {
-                                    isMatched[match.position() + k] = true;
-                                    matchColors[match.position() + k] = 1; 
-                                }
-                            }
-                        }
-                    } catch (...) {}
-                }
+                playgroundViewHeight = textArea.height;
+                if (isDebugging) EnsureDebugAnalysis();
+                size_t visibleFrom, visibleTo;
+                VisibleByteRange(playgroundLayout, playgroundText, playgroundScrollOffset, textArea.height, visibleFrom, visibleTo);
+                UpdatePlaygroundHighlights(visibleFrom, visibleTo);
+                const std::vector<HighlightSpan>& spans = patternCache.spans;
+                const float* adv = GlyphAdvances(mainFont, fontSize);
+
+                // Pass 1: one rectangle per run of same-colored glyphs on a line, walking the spans in step
+                auto span = std::upper_bound(spans.begin(), spans.end(), visibleFrom, [](size_t pos, const HighlightSpan& sp) { return pos < sp.start + sp.length; });
+                Rectangle run = { 0, 0, 0, 0 };
+                int runColor = 0;
+                auto FlushRun = [&]() { if (runColor && run.width > 0) DrawRectangleRec(run, HighlightColor(runColor)); runColor = 0; };
+                ForEachVisibleGlyph(playgroundLayout, mainFont, playgroundText, playgroundScrollOffset, textArea.height, [&](size_t i, char c, float tx, float ty) {
+                    while (span != spans.end() && span->start + span->length <= i) ++span;
+                    int color = (span != spans.end() && span->start <= i) ? span->colorId : 0;
+                    float x = textArea.x + tx, y = textArea.y + ty - playgroundScrollOffset;
+                    if (color != runColor || y != run.y || x != run.x + run.width) {
+                        FlushRun();
+                        run = { x, y, 0, fontSize };
+                        runColor = color;
+                    }
+                    run.width += adv[(unsigned char)c];
+                });
+                FlushRun();
 
-                float tx = 0; float ty = 0; 
-                for (size_t i = 0; i < playgroundText.length(); i++) {
-                    char c = playgroundText[i];
+                // Pass 2: glyphs
+                ForEachVisibleGlyph(playgroundLayout, mainFont, playgroundText, playgroundScrollOffset, textArea.height, [&](size_t, char c, float tx, float ty) {
                     char b[2] = { c, '\0' };
-                    float cw = MeasureTextEx(mainFont, b, fontSize, 1.0f).x;
-                    if (c == '\n') { tx = 0; ty += fontSize; continue; }
-                    if (tx + cw > textArea.width) { tx = 0; ty += fontSize; }
-                    if (isMatched[i]) {
-                        Color hc = Fade(GREEN, 0.4f);
-                        if (isDebugging) {
-                            if (matchColors[i] == 1) hc = COL_GRP_0;
-                            else if (matchColors[i] == 2) hc = COL_GRP_1;
-                            else if (matchColors[i] == 3) hc = COL_GRP_2;
-                            else if (matchColors[i] == 4) hc = COL_GRP_3;
-                        }
-                        DrawRectangle(textArea.x + tx, textArea.y + ty - playgroundScrollOffset, cw, fontSize, hc);
-                    }
                     DrawTextEx(mainFont, b, {textArea.x + tx, textArea.y + ty - playgroundScrollOffset}, fontSize, 1.0f, WHITE);
-                    tx += cw;
-                }
+                });
                 if (mouseOverPlayground && ((int)(cursorBlinkTimer*2)%2==0)) {
-                    DrawRectangle(textArea.x + tx + 2, textArea.y + ty - playgroundScrollOffset, 2, fontSize, WHITE);
+                    Vector2 end = LayoutEndPos(playgroundLayout, mainFont, playgroundText);
+                    DrawRectangle(textArea.x + end.x + 2, textArea.y + end.y - playgroundScrollOffset, 2, fontSize, WHITE);
                 }
             EndScissorMode();
 
+            // MATCH BUDGET WARNING
+            const std::string& budgetWarning = isDebugging ? debugAnalysis.warning : patternCache.matchWarning;
+            if (!budgetWarning.empty()) {
+                Rectangle band = { textArea.x, textArea.y + textArea.height - 22, textArea.width, 22 };
+                DrawRectangleRec(band, Fade(MAROON, 0.85f));
+                DrawTextEx(mainFont, budgetWarning.c_str(), {band.x + 6, band.y + 3}, 14, 1.0f, WHITE);
+            }
+
             if (isDebugging) {
                 float debugY = textArea.y + textArea.height + 10;
                 DrawLine(textArea.x, debugY - 5, textArea.x + textArea.width, debugY - 5, BLUE);
                 if (currentDebugMatches.empty()) {
                     DrawTextEx(mainFont, "No matches found.", {textArea.x, debugY}, 18, 1.0f, RED);
                 } else {
-                    if (GuiButton({textArea.x, debugY, 30, 30}, "<")) {
-                        currentDebugMatchIndex--;
-                        if (currentDebugMatchIndex < 0) currentDebugMatchIndex = currentDebugMatches.size() - 1;
-                    }
-                    std::string counter = "Match " + std::to_string(currentDebugMatchIndex + 1) + " / " + std::to_string(currentDebugMatches.size());
+                    if (GuiButton({textArea.x, debugY, 30, 30}, "<")) StepDebugMatch(-1);
+                    std::string counter = "Match " + std::to_string(currentDebugMatchIndex + 1) + " / " + std::to_string(currentDebugMatches.size()) + (debugAnalysis.complete ? "" : "+");
                     DrawTextEx(mainFont, counter.c_str(), {textArea.x + 40, debugY + 5}, 18, 1.0f, WHITE);
-                    if (GuiButton({textArea.x + 160, debugY, 30, 30}, ">")) {
-                        currentDebugMatchIndex = (currentDebugMatchIndex + 1) % currentDebugMatches.size();
-                    }
+                    if (GuiButton({textArea.x + 160, debugY, 30, 30}, ">")) StepDebugMatch(1);
                     DebugMatch& dm = currentDebugMatches[currentDebugMatchIndex];
                     float grpY = debugY + 40;
                     DrawTextEx(mainFont, "Groups:", {textArea.x, grpY}, 16, 1.0f, GRAY); grpY += 20;
@@ -1228,6 +2923,9 @@ int main() {
         
         DrawTextEx(mainFont, "Pan: Mid-Click | Zoom: Wheel | R-Click: Connect | Del: Delete | Enter: Edit | T: Terminal", {20, (float)curH - panelHeight + 15}, 16, 1.0f, GRAY);
         DrawTextEx(mainFont, "Shift+Click: Multi-Select | Drag: Select Area | Ctrl+C/V/X: Clipboard | SAVE/LOAD: Project", {20, (float)curH - panelHeight + 35}, 16, 1.0f, DARKGRAY);
+        std::string historyStats = FormatHistoryStats();
+        float historyW = MeasureTextEx(mainFont, historyStats.c_str(), 16, 1.0f).x;
+        DrawTextEx(mainFont, historyStats.c_str(), {(float)curW - historyW - 20, (float)curH - panelHeight + 15}, 16, 1.0f, GRAY);
 
         Vector2 c = GetScreenToWorld2D({ (float)curW/2, (float)curH/2 }, camera);
         int startX = 20; 
@@ -1272,6 +2970,7 @@ int main() {
             if (GuiButton({conRect.x + conRect.width - 40, conRect.y, 40, 40}, "X")) showConsole = false;
 
             float contentAreaHeight = conH - 100;
+            if (activeScan || activeBench) contentAreaHeight -= 30; // room for the progress bar
             int totalLines = (int)consoleLog.size();
             int visibleLines = (int)(contentAreaHeight / 25.0f);
             int maxScroll = std::max(0, totalLines - visibleLines);
@@ -1288,19 +2987,39 @@ int main() {
                 if (consoleLog[i].find("[ERROR]") != std::string::npos) c = RED;
                 else if (consoleLog[i].find("HIT:") != std::string::npos) c = ORANGE;
                 else if (consoleLog[i].find("[SUCCESS]") != std::string::npos) c = YELLOW;
+                else if (consoleLog[i].find("[CANCELLED]") != std::string::npos) c = YELLOW;
                 else if (consoleLog[i].find("[USAGE]") != std::string::npos) c = SKYBLUE;
                 
                 DrawTextEx(mainFont, consoleLog[i].c_str(), {conRect.x + 20, logY}, 18, 1.0f, c);
                 logY += 25;
             }
             
+            if (activeScan) {
+                float fraction = 0.0f;
+                std::string progress = FormatScanProgress(*activeScan, fraction);
+                Rectangle bar = { conRect.x + 10, conRect.y + conH - 80, conRect.width - 20, 24 };
+                DrawRectangleRec(bar, Fade(GREEN, 0.1f));
+                DrawRectangleRec({ bar.x, bar.y, bar.width * fraction, bar.height }, Fade(GREEN, 0.4f));
+                DrawRectangleLinesEx(bar, 1, GREEN);
+                DrawTextEx(mainFont, progress.c_str(), {bar.x + 8, bar.y + 4}, 16, 1.0f, WHITE);
+            } else if (activeBench) {
+                int variants = std::max(1, activeBench->Variants());
+                float fraction = (float)activeBench->progress / variants;
+                std::string progress = "Benchmarking " + std::to_string(activeBench->progress.load()) + "/" + std::to_string(variants) + " engine variants...";
+                Rectangle bar = { conRect.x + 10, conRect.y + conH - 80, conRect.width - 20, 24 };
+                DrawRectangleRec(bar, Fade(GREEN, 0.1f));
+                DrawRectangleRec({ bar.x, bar.y, bar.width * fraction, bar.height }, Fade(GREEN, 0.4f));
+                DrawRectangleLinesEx(bar, 1, GREEN);
+                DrawTextEx(mainFont, progress.c_str(), {bar.x + 8, bar.y + 4}, 16, 1.0f, WHITE);
+            }
+
             float inputY = conRect.y + conH - 50;
             DrawRectangle(conRect.x + 10, inputY, conRect.width - 20, 40, Fade(GREEN, 0.1f));
             DrawTextEx(mainFont, ">", {conRect.x + 20, inputY + 10}, 20, 1.0f, GREEN);
             BeginScissorMode((int)conRect.x + 45, (int)inputY, (int)conRect.width - 60, 40);
                 DrawTextEx(mainFont, (consoleInput + (((int)(cursorBlinkTimer*2)%2==0)?"_":"")).c_str(), {conRect.x + 45, inputY + 10}, 20, 1.0f, WHITE);
             EndScissorMode();
-            DrawTextEx(mainFont, "ESC: Close | ENTER: Execute | Ctrl+V: Paste", {conRect.x + 20, conRect.y + conH + 10}, 16, 1.0f, WHITE);
+            DrawTextEx(mainFont, activeScan ? "ESC: Close | Type 'cancel' to stop the scan" : activeBench ? "ESC: Close | Type 'cancel' to stop the bench" : "ESC: Close | ENTER: Execute | Ctrl+V: Paste", {conRect.x + 20, conRect.y + conH + 10}, 16, 1.0f, WHITE);
         }
 
         // HELP OVERLAY
@@ -1310,7 +3029,7 @@ int main() {
             DrawRectangleRec(helpRect, COL_BG);
             DrawRectangleLinesEx(helpRect, 2, WHITE);
             DrawTextEx(mainFont, "HELP & SHORTCUTS", {helpRect.x + 20, helpRect.y + 20}, 24, 1.0f, YELLOW);
-            int ly = helpRect.y + 70; int lh = 30;
+            int ly = helpRect.y + 70; int lh = 28;
             DrawTextEx(mainFont, "- Left Click: Drag / Select (Shift to Add)", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
             DrawTextEx(mainFont, "- Left Drag (Empty): Box Select", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
             DrawTextEx(mainFont, "- Right Click: Connect Nodes", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
@@ -1320,6 +3039,7 @@ int main() {
             DrawTextEx(mainFont, "- DEL: Delete Selected", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
             DrawTextEx(mainFont, "- Ctrl+C/X/V: Copy / Cut / Paste", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
             DrawTextEx(mainFont, "- SAVE / LOAD: Use top buttons", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
+            DrawTextEx(mainFont, "- F3: Profiler Overlay", {helpRect.x + 30, (float)ly}, 20, 1.0f, WHITE); ly += lh;
             
             DrawTextEx(mainFont, "Press ESC to Close", {helpRect.x + 150, helpRect.y + 360}, 18, 1.0f, GRAY);
         }
@@ -1341,10 +3061,15 @@ int main() {
             if (GuiButton({langX, langY, 80, 30}, "PYTHON", currentExportLang == LANG_PYTHON ? YELLOW : BLACK)) currentExportLang = LANG_PYTHON; langX += 90;
             if (GuiButton({langX, langY, 80, 30}, "JS", currentExportLang == LANG_JS ? YELLOW : BLACK)) currentExportLang = LANG_JS; langX += 90;
             if (GuiButton({langX, langY, 80, 30}, "C#", currentExportLang == LANG_CSHARP ? YELLOW : BLACK)) currentExportLang = LANG_CSHARP; langX += 90;
-            if (GuiButton({langX, langY, 80, 30}, "JAVA", currentExportLang == LANG_JAVA ? YELLOW : BLACK)) currentExportLang = LANG_JAVA;
+            if (GuiButton({langX, langY, 80, 30}, "JAVA", currentExportLang == LANG_JAVA ? YELLOW : BLACK)) currentExportLang = LANG_JAVA; langX += 90;
+            if (GuiButton({langX, langY, 100, 30}, "C++ DFA", currentExportLang == LANG_CPP_NATIVE ? YELLOW : BLACK)) currentExportLang = LANG_CPP_NATIVE;
 
             // Generate Code
             std::string codeStr = GetExportCode(regStr, currentExportLang);
+            if (!patternCache.risk.findings.empty()) {
+                std::string riskStr = "Worst case " + patternCache.risk.Complexity() + " on backtracking engines: " + patternCache.risk.findings[0].reason;
+                DrawTextEx(mainFont, riskStr.c_str(), {fullRect.x + 20, fullRect.y + 94}, 14, 1.0f, RiskColor(patternCache.risk.level));
+            }
 
             Rectangle textRect = { fullRect.x + 20, fullRect.y + 110, fullRect.width - 40, 300 };
             Rectangle viewRect = { textRect.x, textRect.y, textRect.width - 20, textRect.height }; // Slightly smaller to fit scrollbar
@@ -1354,7 +3079,8 @@ int main() {
             
             // Calculate Total Height
             float fontSize = 24.0f;
-            float totalHeight = CalculateWrappedHeight(codeStr, fontSize, viewRect.width);
+            LayoutText(codeViewLayout, mainFont, codeStr, std::hash<std::string>{}(codeStr), fontSize, viewRect.width);
+            float totalHeight = codeViewLayout.Height();
             float maxScroll = std::max(0.0f, totalHeight - viewRect.height);
 
             // Handle Scroll Interaction
@@ -1397,7 +3123,7 @@ int main() {
 
             // Draw Text with Scroll Offset
             BeginScissorMode((int)viewRect.x, (int)viewRect.y, (int)viewRect.width, (int)viewRect.height);
-                DrawTextWrapped(mainFont, codeStr, viewRect, fontSize, WHITE, fullRegexScroll);
+                DrawTextWrapped(mainFont, codeStr, codeViewLayout, viewRect, WHITE, fullRegexScroll);
             EndScissorMode();
             
             if (GuiButton({fullRect.x + 20, fullRect.y + 430, 270, 50}, "COPY CODE")) {
@@ -1429,8 +3155,11 @@ int main() {
             if (GuiButton({tplRect.x + 50, tplRect.y + 330, 300, 40}, "CANCEL", RED)) showTemplates = false;
         }
 
+        if (showProfiler) DrawProfilerOverlay(curW);
+        drawScope.reset();
         EndDrawing();
     }
+    if (activeScan) { activeScan->Cancel(); activeScan.reset(); }
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,1310 @@
+#include "regexstudio_core.h"
+
+// Optional archive decompression in the scanner: build with -DREGEX_STUDIO_ZLIB (-lz)
+// and/or -DREGEX_STUDIO_ZSTD (-lzstd). Without them compressed files are sniffed as binary.
+#if defined(REGEX_STUDIO_ZLIB)
+    #include <zlib.h>
+#endif
+#if defined(REGEX_STUDIO_ZSTD)
+    #include <zstd.h>
+#endif
+
+// ----------------------------------------------------------------------------------
+// Profiler
+// ----------------------------------------------------------------------------------
+
+thread_local uint64_t threadAllocations = 0;
+Profiler profiler;
+thread_local ProfileScope* ProfileScope::openZone = nullptr;
+
+// ----------------------------------------------------------------------------------
+// Graph Vocabulary
+// ----------------------------------------------------------------------------------
+
+NodeDefaults DefaultNode(NodeType type) {
+    switch (type) {
+        case NODE_CUSTOM: return { "Custom Text", "abc" };
+        case NODE_START: return { "Start of Line", "^" };
+        case NODE_END: return { "End of Line", "$" };
+        case NODE_TEXT: return { "Letters", "[a-zA-Z]+" };
+        case NODE_DIGIT: return { "Numbers", "\\d" };
+        case NODE_WHITESPACE: return { "Whitespace", "\\s" };
+        case NODE_ANY: return { "Any Char", "." };
+        case NODE_WORD: return { "Word Chars", "\\w" };
+        case NODE_SYMBOL: return { "Symbol @", "@" };
+        case NODE_NOT_DIGIT: return { "Non-Number", "\\D" };
+        case NODE_NOT_WHITESPACE: return { "Non-Space", "\\S" };
+        case NODE_NOT_WORD: return { "Non-Word", "\\W" };
+        case NODE_ZERO_OR_MORE: return { "Repeat (0+)", "*" };
+        case NODE_ONE_OR_MORE: return { "Repeat (1+)", "+" };
+        case NODE_OPTIONAL: return { "Optional", "?" };
+        case NODE_GROUP_START: return { "Start Group", "(" };
+        case NODE_GROUP_END: return { "End Group", ")" };
+        case NODE_OR: return { "OR (Either)", "|" };
+    }
+    return { "", "" };
+}
+
+std::vector<TemplateStep> TemplateSteps(TemplateType type) {
+    switch (type) {
+        case TPL_EMAIL: // \w+@\w+\.\w+
+            return { {NODE_WORD, ""}, {NODE_ONE_OR_MORE, ""}, {NODE_SYMBOL, ""},
+                     {NODE_WORD, ""}, {NODE_ONE_OR_MORE, ""}, {NODE_CUSTOM, "."}, // literal dot
+                     {NODE_WORD, ""}, {NODE_ONE_OR_MORE, ""} };
+
+        case TPL_DATE_ISO: // \d{4}-\d{2}-\d{2}
+            return { {NODE_DIGIT, ""}, {NODE_CUSTOM, "{4}"}, {NODE_CUSTOM, "-"},
+                     {NODE_DIGIT, ""}, {NODE_CUSTOM, "{2}"}, {NODE_CUSTOM, "-"},
+                     {NODE_DIGIT, ""}, {NODE_CUSTOM, "{2}"} };
+
+        case TPL_PHONE_US: // \d{3}-\d{3}-\d{4}
+            return { {NODE_DIGIT, ""}, {NODE_CUSTOM, "{3}"}, {NODE_CUSTOM, "-"},
+                     {NODE_DIGIT, ""}, {NODE_CUSTOM, "{3}"}, {NODE_CUSTOM, "-"},
+                     {NODE_DIGIT, ""}, {NODE_CUSTOM, "{4}"} };
+
+        case TPL_URL_SIMPLE: // https?://\w+\.\w+
+            return { {NODE_CUSTOM, "http"}, {NODE_CUSTOM, "s"}, {NODE_OPTIONAL, ""}, {NODE_CUSTOM, "://"},
+                     {NODE_WORD, ""}, {NODE_ONE_OR_MORE, ""}, {NODE_CUSTOM, "."},
+                     {NODE_WORD, ""}, {NODE_ONE_OR_MORE, ""} };
+
+        case TPL_IP_V4: { // \d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3}
+            std::vector<TemplateStep> steps;
+            for (int i = 0; i < 3; i++) {
+                steps.push_back({NODE_DIGIT, ""});
+                steps.push_back({NODE_CUSTOM, "{1,3}"});
+                steps.push_back({NODE_CUSTOM, "."});
+            }
+            steps.push_back({NODE_DIGIT, ""});
+            steps.push_back({NODE_CUSTOM, "{1,3}"});
+            return steps;
+        }
+
+        case TPL_COUNT: break;
+    }
+    return {};
+}
+
+std::string TemplateRegex(TemplateType type) {
+    std::string regex;
+    for (const auto& step : TemplateSteps(type)) {
+        regex += (step.type == NODE_CUSTOM && step.value[0]) ? step.value : DefaultNode(step.type).regexValue;
+    }
+    return regex;
+}
+
+const char* TemplateName(TemplateType type) {
+    switch (type) {
+        case TPL_EMAIL: return "email";
+        case TPL_DATE_ISO: return "date_iso";
+        case TPL_PHONE_US: return "phone_us";
+        case TPL_URL_SIMPLE: return "url";
+        case TPL_IP_V4: return "ipv4";
+        case TPL_COUNT: break;
+    }
+    return "?";
+}
+
+std::string EncodeProjectBinary(const std::vector<ProjectNode>& nodes, const std::vector<Connection>& connections, int nextNodeId) {
+    std::string strings, records;
+    auto addString = [&](std::string_view v) {
+        PutU32(records, (uint32_t)strings.size());
+        PutU32(records, (uint32_t)v.size());
+        strings += v;
+    };
+    for (const auto& n : nodes) {
+        PutU32(records, (uint32_t)n.id);
+        PutU32(records, (uint32_t)n.type);
+        PutF32(records, n.x);
+        PutF32(records, n.y);
+        records.append((const char*)n.rgba, 4);
+        addString(n.title);
+        addString(n.regexValue);
+    }
+    for (const auto& c : connections) {
+        PutU32(records, (uint32_t)c.fromNodeId);
+        PutU32(records, (uint32_t)c.toNodeId);
+    }
+    records += strings;
+
+    std::string out(VREGEX_MAGIC, sizeof(VREGEX_MAGIC));
+    PutU32(out, VREGEX_FLAG_CHECKSUM);
+    PutU32(out, (uint32_t)nodes.size());
+    PutU32(out, (uint32_t)connections.size());
+    PutU32(out, (uint32_t)strings.size());
+    PutU32(out, (uint32_t)nextNodeId);
+    PutU32(out, Fnv1a(records.data(), records.size()));
+    return out + records;
+}
+
+bool DecodeProjectBinary(const char* data, size_t size, std::vector<ProjectNode>& outNodes, std::vector<Connection>& outConns, int& outNextId, std::string& error) {
+    if (size < VREGEX_HEADER_SIZE) { error = "truncated header"; return false; }
+    uint32_t flags = GetU32(data + 8);
+    uint64_t nodeCount = GetU32(data + 12), connCount = GetU32(data + 16), stringBytes = GetU32(data + 20);
+    outNextId = (int)GetU32(data + 24);
+    uint32_t checksum = GetU32(data + 28);
+    if (flags & ~VREGEX_FLAG_CHECKSUM) { error = "unknown flags " + std::to_string(flags); return false; }
+    uint64_t expected = VREGEX_HEADER_SIZE + nodeCount * VREGEX_NODE_SIZE + connCount * VREGEX_CONN_SIZE + stringBytes;
+    if (expected != size) { error = "size mismatch (header says " + std::to_string(expected) + " bytes, file has " + std::to_string(size) + ")"; return false; }
+    if ((flags & VREGEX_FLAG_CHECKSUM) && Fnv1a(data + VREGEX_HEADER_SIZE, size - VREGEX_HEADER_SIZE) != checksum) { error = "checksum mismatch"; return false; }
+
+    const char* rec = data + VREGEX_HEADER_SIZE;
+    const char* strings = rec + nodeCount * VREGEX_NODE_SIZE + connCount * VREGEX_CONN_SIZE;
+    auto getString = [&](const char* p, std::string_view& out) {
+        uint64_t off = GetU32(p), len = GetU32(p + 4);
+        if (off + len > stringBytes) return false;
+        out = std::string_view(strings + off, (size_t)len);
+        return true;
+    };
+    std::unordered_set<int> ids;
+    outNodes.clear();
+    outNodes.reserve((size_t)nodeCount);
+    for (uint64_t i = 0; i < nodeCount; i++, rec += VREGEX_NODE_SIZE) {
+        ProjectNode n;
+        n.id = (int)GetU32(rec);
+        uint32_t type = GetU32(rec + 4);
+        if (type > NODE_OR) { error = "node " + std::to_string(i) + " has an unknown type"; return false; }
+        if (!ids.insert(n.id).second) { error = "duplicate node id " + std::to_string(n.id); return false; }
+        n.type = (NodeType)type;
+        n.x = GetF32(rec + 8);
+        n.y = GetF32(rec + 12);
+        memcpy(n.rgba, rec + 16, 4);
+        if (!getString(rec + 20, n.title) || !getString(rec + 28, n.regexValue)) { error = "node " + std::to_string(i) + " string out of range"; return false; }
+        outNodes.push_back(n);
+    }
+    outConns.clear();
+    outConns.reserve((size_t)connCount);
+    for (uint64_t i = 0; i < connCount; i++, rec += VREGEX_CONN_SIZE) {
+        outConns.push_back({ (int)GetU32(rec), (int)GetU32(rec + 4) });
+    }
+    return true;
+}
+
+bool TokenizeRegex(const std::string& re, std::vector<ImportToken>& out, std::string& error) {
+    out.clear();
+    out.reserve(re.size() / 2 + 1);
+    int depth = 0;
+    size_t runBegin = std::string::npos, pieceBegin = 0; // open literal run and its last atom
+    auto closeRun = [&](size_t end) {
+        if (runBegin != std::string::npos) out.push_back({ NODE_CUSTOM, runBegin, end - runBegin, depth });
+        runBegin = std::string::npos;
+    };
+    auto emit = [&](NodeType type, size_t begin, size_t len) {
+        closeRun(begin);
+        out.push_back({ type, begin, len, depth });
+    };
+    size_t i = 0, n = re.size();
+    while (i < n) {
+        char c = re[i];
+        if (c == '*' || c == '+' || c == '?' || (c == '{' && i + 1 < n && isdigit((unsigned char)re[i + 1]))) {
+            size_t end = i + 1;
+            if (c == '{') {
+                while (end < n && (isdigit((unsigned char)re[end]) || re[end] == ',')) end++;
+                if (end >= n || re[end] != '}') { if (runBegin == std::string::npos) runBegin = i; pieceBegin = i; i++; continue; } // literal '{'
+                end++;
+            }
+            if (end < n && (re[end] == '?' || re[end] == '+')) end++; // lazy / possessive suffix
+            if (runBegin != std::string::npos && pieceBegin > runBegin) {
+                // The quantifier binds to the last atom only, so it gets a node of its own
+                out.push_back({ NODE_CUSTOM, runBegin, pieceBegin - runBegin, depth });
+                runBegin = pieceBegin;
+            }
+            NodeType type = NODE_CUSTOM;
+            if (end == i + 1) type = c == '*' ? NODE_ZERO_OR_MORE : c == '+' ? NODE_ONE_OR_MORE : c == '?' ? NODE_OPTIONAL : NODE_CUSTOM;
+            emit(type, i, end - i);
+            i = end;
+            continue;
+        }
+        switch (c) {
+            case '^': emit(i == 0 ? NODE_START : NODE_CUSTOM, i, 1); i++; break; // a later START would become the chain head
+            case '$': emit(NODE_END, i, 1); i++; break;
+            case '.': emit(NODE_ANY, i, 1); i++; break;
+            case '|': emit(NODE_OR, i, 1); i++; break;
+            case '(': {
+                size_t len = 1;
+                if (i + 1 < n && re[i + 1] == '?') {
+                    len = 3; // (?: (?= (?!
+                    if (i + 2 < n && re[i + 2] == '<') len = 4; // (?<= (?<!
+                    if (i + len > n) { error = "incomplete group at offset " + std::to_string(i); return false; }
+                }
+                emit(len == 1 ? NODE_GROUP_START : NODE_CUSTOM, i, len);
+                depth++;
+                i += len;
+                break;
+            }
+            case ')':
+                if (depth == 0) { error = "unmatched ')' at offset " + std::to_string(i); return false; }
+                depth--;
+                emit(NODE_GROUP_END, i, 1);
+                i++;
+                break;
+            case '[': {
+                size_t end = i + 1;
+                if (end < n && re[end] == '^') end++;
+                if (end < n && re[end] == ']') end++; // a leading ']' is literal
+                while (end < n && re[end] != ']') end += (re[end] == '\\') ? 2 : 1;
+                if (end >= n) { error = "unterminated '[' at offset " + std::to_string(i); return false; }
+                emit(NODE_CUSTOM, i, end + 1 - i);
+                i = end + 1;
+                break;
+            }
+            case '\\': {
+                if (i + 1 >= n) { error = "trailing '\\'"; return false; }
+                char e = re[i + 1];
+                NodeType type = NODE_CUSTOM;
+                switch (e) {
+                    case 'd': type = NODE_DIGIT; break;
+                    case 'w': type = NODE_WORD; break;
+                    case 's': type = NODE_WHITESPACE; break;
+                    case 'D': type = NODE_NOT_DIGIT; break;
+                    case 'W': type = NODE_NOT_WORD; break;
+                    case 'S': type = NODE_NOT_WHITESPACE; break;
+                }
+                size_t len = 2;
+                if (type != NODE_CUSTOM || e == 'b' || e == 'B' || (e >= '1' && e <= '9')) {
+                    if (e >= '1' && e <= '9') while (i + len < n && isdigit((unsigned char)re[i + len])) len++; // backreference
+                    emit(type, i, len);
+                } else {
+                    // Escaped literal (\. \n \x41 A \cA): part of the literal run
+                    if (e == 'x') len = 4; else if (e == 'u') len = 6; else if (e == 'c') len = 3;
+                    len = std::min(len, n - i);
+                    if (runBegin == std::string::npos) runBegin = i;
+                    pieceBegin = i;
+                }
+                i += len;
+                break;
+            }
+            default:
+                if (runBegin == std::string::npos) runBegin = i;
+                pieceBegin = i;
+                i++;
+                break;
+        }
+    }
+    closeRun(n);
+    if (depth != 0) { error = std::to_string(depth) + " unclosed '('"; return false; }
+    return true;
+}
+
+std::string_view ImportedFragment(const ImportToken& tok, std::string_view re) {
+    if (tok.type == NODE_CUSTOM) return re.substr(tok.begin, tok.len);
+    return DefaultNode(tok.type).regexValue;
+}
+
+// ----------------------------------------------------------------------------------
+// Regex Engine Layer
+// ----------------------------------------------------------------------------------
+
+std::string FormatMatchAbort(const MatchBudgetExceeded& e, size_t base) {
+    char ms[32];
+    snprintf(ms, sizeof(ms), "%.0f", e.millis);
+    return "pattern aborted after " + std::string(ms) + " ms on offset " + std::to_string(base + e.offset);
+}
+
+void ReEmit(const ReNode& n, ReProg& prog, bool reverse) {
+    std::vector<ReInst>& code = prog.insts;
+    if (code.size() > RE_MAX_INSTS) throw std::runtime_error("pattern too large for dfa");
+    switch (n.type) {
+        case RE_EMPTY: break;
+        case RE_SET: code.push_back({ OP_CHAR, n.set, 0 }); break;
+        case RE_BOL: code.push_back({ reverse ? OP_EOL : OP_BOL, 0, 0 }); break;
+        case RE_EOL: code.push_back({ reverse ? OP_BOL : OP_EOL, 0, 0 }); break;
+        case RE_CAT:
+            if (reverse) for (int k = (int)n.kids.size() - 1; k >= 0; k--) ReEmit(n.kids[k], prog, reverse);
+            else for (const auto& k : n.kids) ReEmit(k, prog, reverse);
+            break;
+        case RE_GROUP:
+            if (!reverse && n.capture >= 0) code.push_back({ OP_SAVE, n.capture * 2, 0 });
+            ReEmit(n.kids[0], prog, reverse);
+            if (!reverse && n.capture >= 0) code.push_back({ OP_SAVE, n.capture * 2 + 1, 0 });
+            break;
+        case RE_ALT: {
+            std::vector<size_t> jumps;
+            for (size_t k = 0; k < n.kids.size(); k++) {
+                if (k + 1 < n.kids.size()) {
+                    size_t split = code.size();
+                    code.push_back({ OP_SPLIT, (int)split + 1, 0 });
+                    ReEmit(n.kids[k], prog, reverse);
+                    jumps.push_back(code.size());
+                    code.push_back({ OP_JMP, 0, 0 });
+                    code[split].y = (int)code.size();
+                } else {
+                    ReEmit(n.kids[k], prog, reverse);
+                }
+            }
+            for (size_t j : jumps) code[j].x = (int)code.size();
+            break;
+        }
+        case RE_REPEAT: {
+            const ReNode& body = n.kids[0];
+            int required = n.min;
+            if (n.max == -1 && required > 0) required--; // last copy becomes the x+ loop
+            for (int k = 0; k < required; k++) ReEmit(body, prog, reverse);
+            if (n.max == -1) {
+                if (n.min == 0) {
+                    size_t loop = code.size();
+                    code.push_back({ OP_SPLIT, 0, 0 });
+                    ReEmit(body, prog, reverse);
+                    code.push_back({ OP_JMP, (int)loop, 0 });
+                    int bodyPc = (int)loop + 1, exitPc = (int)code.size();
+                    code[loop].x = n.greedy ? bodyPc : exitPc;
+                    code[loop].y = n.greedy ? exitPc : bodyPc;
+                } else {
+                    int bodyPc = (int)code.size();
+                    ReEmit(body, prog, reverse);
+                    int exitPc = (int)code.size() + 1;
+                    code.push_back({ OP_SPLIT, n.greedy ? bodyPc : exitPc, n.greedy ? exitPc : bodyPc });
+                }
+            } else {
+                std::vector<size_t> splits;
+                for (int k = n.min; k < n.max; k++) {
+                    splits.push_back(code.size());
+                    code.push_back({ OP_SPLIT, 0, 0 });
+                    ReEmit(body, prog, reverse);
+                }
+                int exitPc = (int)code.size();
+                for (size_t sp : splits) {
+                    int bodyPc = (int)sp + 1;
+                    code[sp].x = n.greedy ? bodyPc : exitPc;
+                    code[sp].y = n.greedy ? exitPc : bodyPc;
+                }
+            }
+            break;
+        }
+    }
+}
+
+void ReCompile(const ReNode& root, ReProg& prog, bool reverse) {
+    prog.insts.clear();
+    prog.start = 0;
+    if (!reverse) prog.insts.push_back({ OP_SAVE, 0, 0 });
+    ReEmit(root, prog, reverse);
+    if (!reverse) prog.insts.push_back({ OP_SAVE, 1, 0 });
+    prog.insts.push_back({ OP_MATCH, 0, 0 });
+}
+
+bool PikeMatch(const ReProg& prog, const std::vector<ByteSet>& sets, int slots,
+               const unsigned char* text, size_t len, size_t start, bool notNull, std::vector<long>& outCaps) {
+    struct Thread { int pc; std::vector<long> caps; };
+    struct Entry { int pc; int slot; long old; };
+    std::vector<Thread> clist, nlist;
+    std::vector<unsigned int> mark(prog.insts.size(), 0);
+    unsigned int gen = 0;
+    std::vector<Entry> stack;
+    bool found = false;
+
+    auto addThread = [&](std::vector<Thread>& list, int pc0, std::vector<long> caps, size_t pos) {
+        stack.clear();
+        stack.push_back({ pc0, -1, 0 });
+        while (!stack.empty()) {
+            Entry e = stack.back(); stack.pop_back();
+            if (e.slot >= 0) { caps[e.slot] = e.old; continue; }
+            if (mark[e.pc] == gen) continue;
+            mark[e.pc] = gen;
+            const ReInst& in = prog.insts[e.pc];
+            switch (in.op) {
+                case OP_JMP: stack.push_back({ in.x, -1, 0 }); break;
+                case OP_SPLIT: stack.push_back({ in.y, -1, 0 }); stack.push_back({ in.x, -1, 0 }); break;
+                case OP_SAVE:
+                    stack.push_back({ 0, in.x, caps[in.x] });
+                    caps[in.x] = (long)pos;
+                    stack.push_back({ e.pc + 1, -1, 0 });
+                    break;
+                case OP_BOL: if (pos == 0) stack.push_back({ e.pc + 1, -1, 0 }); break;
+                case OP_EOL: if (pos == len) stack.push_back({ e.pc + 1, -1, 0 }); break;
+                case OP_CHAR: case OP_MATCH: list.push_back({ e.pc, caps }); break;
+            }
+        }
+    };
+
+    gen++;
+    addThread(clist, prog.start, std::vector<long>(slots, -1), start);
+    for (size_t pos = start; !clist.empty(); pos++) {
+        nlist.clear();
+        gen++;
+        for (const Thread& t : clist) {
+            const ReInst& in = prog.insts[t.pc];
+            if (in.op == OP_MATCH) {
+                if (notNull && pos == start) continue;
+                outCaps = t.caps; found = true; break;
+            }
+            if (pos < len && sets[in.x].test(text[pos])) addThread(nlist, t.pc + 1, t.caps, pos + 1);
+        }
+        if (pos >= len) break;
+        std::swap(clist, nlist);
+    }
+    return found;
+}
+
+void AppendNativeTable(std::string& out, const char* name, const NativeTable& t) {
+    int classes = (int)t.classReps.size();
+    const char* stateType = t.dfa.stateCount <= 256 ? "uint8_t" : "uint16_t";
+    out += "inline constexpr " + std::string(stateType) + " " + name + "[] = {";
+    for (int s = 0; s < t.dfa.stateCount; s++) {
+        out += "\n   ";
+        for (int k = 0; k < classes; k++) out += " " + std::to_string(t.dfa.trans[(size_t)s * 256 + t.classReps[k]]) + ",";
+    }
+    out += "\n};\ninline constexpr uint8_t " + std::string(name) + "Flags[] = {";
+    for (int s = 0; s < t.dfa.stateCount; s++) out += (s % 32 ? " " : "\n    ") + std::to_string((int)t.dfa.flags[s]) + ",";
+    out += "\n};\ninline constexpr int " + std::string(name) + "Start[8] = {";
+    for (int k = 0; k < 8; k++) out += std::string(k ? ", " : " ") + std::to_string(std::max(0, t.dfa.start[k]));
+    out += " };\n";
+}
+
+bool GenerateNativeMatcher(const std::string& pattern, const std::string& ns, std::string& code, std::string& error) {
+    std::vector<ByteSet> sets;
+    ReProg forwardProg, reverseProg;
+    try {
+        ReParser parser(pattern, sets);
+        ReNode root = parser.Parse();
+        ReCompile(root, forwardProg, false);
+        ReCompile(root, reverseProg, true);
+    } catch (const std::exception& e) { error = e.what(); return false; }
+
+    NativeTable fwd, rev;
+    LazyDfa forward, reverse;
+    forward.Init(&forwardProg, &sets, true);
+    reverse.Init(&reverseProg, &sets, false);
+    // forward: unanchored search (notNull = 0) and the anchored non-empty retry (notNull = 1)
+    if (!forward.Materialize((1u << 2) | (1u << 6) | (1u << 1) | (1u << 5), NATIVE_MAX_STATES, fwd.dfa) ||
+        !reverse.Materialize((1u << 0) | (1u << 4), NATIVE_MAX_STATES, rev.dfa)) {
+        error = "automaton exceeds " + std::to_string(NATIVE_MAX_STATES) + " states";
+        return false;
+    }
+
+    // BYTE CLASSES: bytes that belong to exactly the same sets never take different edges
+    std::vector<int> byteClass(256);
+    std::map<std::vector<bool>, int> classOf;
+    std::vector<int> classReps;
+    for (int c = 0; c < 256; c++) {
+        std::vector<bool> signature(sets.size());
+        for (size_t k = 0; k < sets.size(); k++) signature[k] = sets[k].test(c);
+        auto it = classOf.find(signature);
+        if (it == classOf.end()) { it = classOf.emplace(signature, (int)classReps.size()).first; classReps.push_back(c); }
+        byteClass[c] = it->second;
+    }
+    fwd.classReps = rev.classReps = classReps;
+
+    std::string shown;
+    for (unsigned char c : pattern) {
+        if (c >= 0x20 && c < 0x7F) shown += (char)c;
+        else { char esc[8]; snprintf(esc, sizeof(esc), "\\x%02X", c); shown += esc; }
+    }
+    code = "// Generated by Regex Studio from the pattern:\n//   " + shown + "\n"
+           "// std::regex (ECMAScript) leftmost-first semantics, no allocation, no dependencies.\n"
+           "// " + std::to_string(fwd.dfa.stateCount) + " forward + " + std::to_string(rev.dfa.stateCount) + " reverse states over " +
+           std::to_string(classReps.size()) + " byte classes.\n"
+           "#pragma once\n#include <cstddef>\n#include <cstdint>\n#include <string_view>\n\n"
+           "namespace " + ns + " {\n\nstruct Match { size_t start; size_t end; };\n\nnamespace detail {\n\n"
+           "inline constexpr int kClasses = " + std::to_string(classReps.size()) + ";\n"
+           "inline constexpr uint8_t kClass[256] = {";
+    for (int c = 0; c < 256; c++) code += (c % 32 ? " " : "\n    ") + std::to_string(byteClass[c]) + ",";
+    code += "\n};\n";
+    AppendNativeTable(code, "kFwd", fwd);
+    AppendNativeTable(code, "kRev", rev);
+    code += R"CPP(
+// End of the leftmost-first match beginning at or after 'from', or -1
+inline long FindEnd(const unsigned char* t, size_t len, size_t from, bool notNull) {
+    int s = kFwdStart[(from == 0 ? 4 : 0) + (notNull ? 1 : 2)];
+    long last = (kFwdFlags[s] & 1) ? (long)from : -1;
+    for (size_t p = from; p < len; p++) {
+        if (kFwdFlags[s] & 2) return last;
+        s = kFwd[s * kClasses + kClass[t[p]]];
+        if (kFwdFlags[s] & 1) last = (long)p + 1;
+    }
+    if (!(kFwdFlags[s] & 2) && (!notNull || len > from) && (kFwdFlags[s] & 4)) last = (long)len;
+    return last;
+}
+
+// Smallest start in [limit, end] so that [start, end) matches, or -1
+inline long FindStart(const unsigned char* t, size_t len, size_t end, size_t limit) {
+    int s = kRevStart[end == len ? 4 : 0];
+    long best = (kRevFlags[s] & 1) ? (long)end : -1;
+    for (size_t p = end; p > limit; p--) {
+        if (kRevFlags[s] & 2) return best;
+        s = kRev[s * kClasses + kClass[t[p - 1]]];
+        if (kRevFlags[s] & 1) best = (long)p - 1;
+    }
+    if (limit == 0 && !(kRevFlags[s] & 2) && (kRevFlags[s] & 4)) best = 0;
+    return best;
+}
+
+} // namespace detail
+
+// Calls fn(Match) for every match in std::regex_iterator order; fn returns false to stop
+template <typename Fn>
+inline void for_each(std::string_view text, Fn&& fn, size_t from = 0) {
+    const unsigned char* t = (const unsigned char*)text.data();
+    size_t len = text.size(), pos = from;
+    bool retryNotNull = false;
+    while (pos <= len) {
+        long s, e;
+        if (retryNotNull) {
+            retryNotNull = false;
+            e = detail::FindEnd(t, len, pos, true);
+            if (e < 0) { pos++; continue; }
+            s = (long)pos;
+        } else {
+            e = detail::FindEnd(t, len, pos, false);
+            if (e < 0) return;
+            s = detail::FindStart(t, len, (size_t)e, pos);
+            if (s < 0) s = e;
+        }
+        if (!fn(Match{ (size_t)s, (size_t)e })) return;
+        if (e == s) retryNotNull = true;
+        pos = (size_t)e;
+    }
+}
+
+// First match starting at or after 'from'
+inline bool search(std::string_view text, Match& m, size_t from = 0) {
+    bool found = false;
+    for_each(text, [&](const Match& hit) { m = hit; found = true; return false; }, from);
+    return found;
+}
+
+inline size_t count(std::string_view text) {
+    size_t n = 0;
+    for_each(text, [&](const Match&) { n++; return true; });
+    return n;
+}
+
+// The whole text matches (std::regex_match)
+inline bool full_match(std::string_view text) {
+    return detail::FindStart((const unsigned char*)text.data(), text.size(), text.size(), 0) == 0;
+}
+
+} // namespace )CPP" + ns + "\n";
+    return true;
+}
+
+void KeepLongest(std::string& best, const std::string& candidate) {
+    if (candidate.size() > best.size()) best = candidate.substr(0, LITERAL_MAX);
+}
+
+LiteralInfo AnalyzeLiterals(const ReNode& n, const std::vector<ByteSet>& sets) {
+    LiteralInfo info;
+    switch (n.type) {
+        case RE_EMPTY: case RE_BOL: case RE_EOL:
+            info.exact = true;
+            break;
+        case RE_SET: {
+            const ByteSet& b = sets[n.set];
+            if (b.count() == 1) {
+                for (int c = 0; c < 256; c++) if (b.test(c)) info.str = std::string(1, (char)c);
+                info.exact = true;
+                info.prefix = info.suffix = info.best = info.str;
+            }
+            break;
+        }
+        case RE_GROUP:
+            return AnalyzeLiterals(n.kids[0], sets);
+        case RE_ALT:
+            break; // no common-factor analysis: an alternation requires nothing
+        case RE_REPEAT: {
+            if (n.min == 0) break;
+            LiteralInfo kid = AnalyzeLiterals(n.kids[0], sets);
+            if (kid.exact && n.min == n.max && kid.str.size() * n.min <= LITERAL_MAX) {
+                info.exact = true;
+                for (int k = 0; k < n.min; k++) info.str += kid.str;
+                info.prefix = info.suffix = info.best = info.str;
+            } else {
+                info.prefix = kid.exact ? kid.str : kid.prefix;
+                info.suffix = kid.exact ? kid.str : kid.suffix;
+                info.best = kid.exact ? kid.str : kid.best;
+            }
+            break;
+        }
+        case RE_CAT: {
+            std::string run;          // exact text accumulated since the last inexact kid
+            bool allExact = true;
+            for (const auto& k : n.kids) {
+                LiteralInfo kid = AnalyzeLiterals(k, sets);
+                if (kid.exact) { run += kid.str; if (run.size() > LITERAL_MAX) run.erase(0, run.size() - LITERAL_MAX); continue; }
+                if (allExact) info.prefix = run + kid.prefix;
+                KeepLongest(info.best, run + kid.prefix);
+                KeepLongest(info.best, kid.best);
+                run = kid.suffix;
+                allExact = false;
+            }
+            KeepLongest(info.best, run);
+            if (allExact) { info.exact = true; info.str = run; info.prefix = run; }
+            info.suffix = run;
+            break;
+        }
+    }
+    return info;
+}
+
+bool ReHasEol(const ReNode& n) {
+    if (n.type == RE_EOL) return true;
+    for (const auto& k : n.kids) if (ReHasEol(k)) return true;
+    return false;
+}
+#if defined(REGEX_STUDIO_X86_SIMD)
+__attribute__((target("avx2")))
+size_t FindLiteralAvx2(const char* hay, size_t n, const char* needle, size_t m, size_t i) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i*)(hay + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i*)(hay + i + m - 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last)));
+        while (mask) {
+            int bit = LowestBit(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return i; // caller finishes the tail
+}
+
+__attribute__((target("sse2")))
+size_t FindLiteralSse2(const char* hay, size_t n, const char* needle, size_t m, size_t i) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i*)(hay + i));
+        __m128i bl = _mm_loadu_si128((const __m128i*)(hay + i + m - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last)));
+        while (mask) {
+            int bit = LowestBit(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return i;
+}
+#endif
+
+size_t FindLiteral(const char* hay, size_t n, size_t from, const std::string& needle) {
+    size_t m = needle.size();
+    if (m == 0) return from;
+    if (from + m > n) return n;
+    if (m == 1) {
+        const void* p = memchr(hay + from, needle[0], n - from);
+        return p ? (size_t)((const char*)p - hay) : n;
+    }
+    size_t i = from;
+    const char* nd = needle.data();
+    auto found = [&](size_t pos) { return pos + m <= n && hay[pos] == nd[0] && memcmp(hay + pos + 1, nd + 1, m - 1) == 0; };
+#if defined(REGEX_STUDIO_X86_SIMD)
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    i = hasAvx2 ? FindLiteralAvx2(hay, n, nd, m, i) : FindLiteralSse2(hay, n, nd, m, i);
+    if (found(i)) return i;
+#elif defined(__ARM_NEON)
+    const uint8x16_t first = vdupq_n_u8((uint8_t)nd[0]);
+    const uint8x16_t last = vdupq_n_u8((uint8_t)nd[m - 1]);
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8((const uint8_t*)hay + i), first),
+                                 vceqq_u8(vld1q_u8((const uint8_t*)hay + i + m - 1), last));
+        // 4 mask bits per byte lane
+        unsigned long long mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask) {
+            int bit = LowestBit(mask) / 4;
+            if (memcmp(hay + i + bit + 1, nd + 1, m - 2) == 0) return i + bit;
+            mask &= ~(0xFULL << (bit * 4));
+        }
+    }
+#endif
+    for (; i + m <= n; i++) if (found(i)) return i;
+    return n;
+}
+
+size_t SearchChunkWindow(const LiteralPrefilter& prefilter, RegexEngine& engine, const char* data, size_t size,
+                         size_t from, size_t boundary, bool last, const std::function<void(const EngineMatch&)>& fn) {
+    size_t lastEnd = from;
+    prefilter.ForEach(engine, data, data + size, from, [&](const EngineMatch& m) {
+        if (!last && m.start >= boundary) return false;
+        fn(m);
+        lastEnd = m.start + m.length;
+        return true;
+    });
+    return std::max(lastEnd, boundary);
+}
+
+PatternRisk AnalyzePatternComplexity(const std::string& pattern) {
+    return ComplexityAnalyzer().Run(pattern);
+}
+
+bool ReNullable(const ReNode& n) {
+    switch (n.type) {
+        case RE_EMPTY: case RE_BOL: case RE_EOL: return true;
+        case RE_SET: return false;
+        case RE_GROUP: return ReNullable(n.kids[0]);
+        case RE_REPEAT: return n.min == 0 || ReNullable(n.kids[0]);
+        case RE_CAT:
+            for (const auto& k : n.kids) if (!ReNullable(k)) return false;
+            return true;
+        case RE_ALT:
+            for (const auto& k : n.kids) if (ReNullable(k)) return true;
+            return false;
+    }
+    return false;
+}
+
+bool ReHasEmptyLoop(const ReNode& n) {
+    if (n.type == RE_REPEAT && n.max != n.min && ReNullable(n.kids[0])) return true;
+    for (const auto& k : n.kids) if (ReHasEmptyLoop(k)) return true;
+    return false;
+}
+
+bool DfaMatchesStdSemantics(const std::string& pattern) {
+    try {
+        std::vector<ByteSet> sets;
+        ReParser parser(pattern, sets);
+        return !ReHasEmptyLoop(parser.Parse());
+    } catch (...) {
+        return true; // not dfa syntax: the dfa compile reports it
+    }
+}
+
+std::unique_ptr<RegexEngine> CompileEngine(EngineType type, const std::string& pattern, std::string& error) {
+    ProfileScope scope(PROF_COMPILE);
+    if (type == ENGINE_AUTO && !DfaMatchesStdSemantics(pattern)) type = ENGINE_STD;
+    if (type == ENGINE_DFA || type == ENGINE_AUTO) {
+        std::unique_ptr<RegexEngine> dfa(new DfaRegexEngine());
+        if (dfa->Compile(pattern, error)) return dfa;
+        if (type == ENGINE_DFA) return nullptr;
+    }
+    std::unique_ptr<RegexEngine> stdEngine(new StdRegexEngine());
+    if (stdEngine->Compile(pattern, error)) return stdEngine;
+    return nullptr;
+}
+
+const char* EngineTypeName(EngineType type) {
+    switch (type) {
+        case ENGINE_STD: return "std";
+        case ENGINE_DFA: return "dfa";
+        case ENGINE_AUTO: return "auto";
+    }
+    return "?";
+}
+
+uint32_t Fnv1a(const char* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) { h ^= (unsigned char)data[i]; h *= 16777619u; }
+    return h;
+}
+
+void PutU32(std::string& out, uint32_t v) {
+    for (int k = 0; k < 4; k++) out += (char)((v >> (8 * k)) & 0xFF);
+}
+
+void PutF32(std::string& out, float f) {
+    uint32_t v; memcpy(&v, &f, 4); PutU32(out, v);
+}
+
+uint32_t GetU32(const char* p) {
+    const unsigned char* b = (const unsigned char*)p;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+float GetF32(const char* p) {
+    uint32_t v = GetU32(p); float f; memcpy(&f, &v, 4); return f;
+}
+
+uint64_t Fnv1a64(const char* data, size_t size, uint64_t h) {
+    for (size_t i = 0; i < size; i++) { h ^= (unsigned char)data[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+void PutU64(std::string& out, uint64_t v) {
+    PutU32(out, (uint32_t)v);
+    PutU32(out, (uint32_t)(v >> 32));
+}
+
+uint64_t GetU64(const char* p) {
+    return (uint64_t)GetU32(p) | ((uint64_t)GetU32(p + 4) << 32);
+}
+
+// ----------------------------------------------------------------------------------
+// File Scanner
+// ----------------------------------------------------------------------------------
+
+#if defined(REGEX_STUDIO_X86_SIMD)
+__attribute__((target("avx2,popcnt")))
+size_t CountNewlinesAvx2(const char* p, size_t n, size_t& i) {
+    size_t count = 0;
+    const __m256i nl = _mm256_set1_epi8('\n');
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        count += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+    }
+    return count;
+}
+
+__attribute__((target("sse2")))
+size_t CountNewlinesSse2(const char* p, size_t n, size_t& i) {
+    size_t count = 0;
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        count += __builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+    }
+    return count;
+}
+#endif
+
+size_t CountNewlines(const char* p, size_t n) {
+    size_t count = 0, i = 0;
+#if defined(REGEX_STUDIO_X86_SIMD)
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    count = hasAvx2 ? CountNewlinesAvx2(p, n, i) : CountNewlinesSse2(p, n, i);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    const uint8x16_t one = vdupq_n_u8(1);
+    for (; i + 16 <= n; i += 16) count += vaddvq_u8(vandq_u8(vceqq_u8(vld1q_u8((const uint8_t*)p + i), nl), one));
+#endif
+    for (; i < n; i++) if (p[i] == '\n') count++;
+    return count;
+}
+
+bool GlobMatch(const char* p, const char* s) {
+    while (*p) {
+        if (p[0] == '*' && p[1] == '*') {
+            p += 2;
+            if (*p == '/' && GlobMatch(p + 1, s)) return true; // "**/" also matches zero directories
+            for (;; s++) {
+                if (GlobMatch(p, s)) return true;
+                if (!*s) return false;
+            }
+        }
+        if (*p == '*') {
+            p++;
+            for (;; s++) {
+                if (GlobMatch(p, s)) return true;
+                if (!*s || *s == '/') return false;
+            }
+        }
+        if (!*s) return false;
+        if (*p == '?') {
+            if (*s == '/') return false;
+            p++; s++;
+            continue;
+        }
+        if (*p == '[') {
+            const char* q = p + 1;
+            bool negate = (*q == '!' || *q == '^');
+            if (negate) q++;
+            bool hit = false;
+            for (bool first = true; *q && (first || *q != ']'); first = false) {
+                if (q[1] == '-' && q[2] && q[2] != ']') { hit = hit || (*s >= q[0] && *s <= q[2]); q += 3; }
+                else { hit = hit || (*s == *q); q++; }
+            }
+            if (*q == ']') {
+                if (hit == negate || *s == '/') return false;
+                p = q + 1; s++;
+                continue;
+            } // unterminated class: the '[' is literal
+        }
+        if (*p == '\\' && p[1]) p++;
+        if (*p != *s) return false;
+        p++; s++;
+    }
+    return !*s;
+}
+
+bool MakeGlobRule(std::string line, const std::string& base, GlobRule& rule) {
+    while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r')) line.pop_back();
+    if (line.empty() || line[0] == '#') return false;
+    rule = GlobRule();
+    rule.base = base;
+    if (line[0] == '!') { rule.negate = true; line.erase(0, 1); }
+    if (!line.empty() && line.back() == '/') { rule.dirOnly = true; line.pop_back(); }
+    if (line.empty()) return false;
+    bool anchored = line.find('/') != std::string::npos;
+    if (line[0] == '/') line.erase(0, 1);
+    rule.glob = anchored ? line : "**/" + line;
+    return true;
+}
+
+bool GlobRuleMatches(const GlobRule& rule, const std::string& rel, bool isDir) {
+    if (rule.dirOnly && !isDir) return false;
+    if (rel.compare(0, rule.base.size(), rule.base) != 0) return false;
+    return GlobMatch(rule.glob.c_str(), rel.c_str() + rule.base.size());
+}
+
+int LastGlobMatch(const std::vector<GlobRule>& rules, const std::string& rel, bool isDir) {
+    for (size_t k = rules.size(); k-- > 0;) {
+        if (GlobRuleMatches(rules[k], rel, isDir)) return rules[k].negate ? 0 : 1;
+    }
+    return -1;
+}
+
+bool LooksBinary(const char* data, size_t size) {
+    return memchr(data, 0, std::min(size, BINARY_SNIFF)) != nullptr;
+}
+
+bool ParseByteSize(const std::string& text, uintmax_t& out) {
+    char* end = nullptr;
+    double v = strtod(text.c_str(), &end);
+    if (end == text.c_str() || v <= 0) return false;
+    std::string unit(end);
+    double scale = 1;
+    if (unit == "k" || unit == "K") scale = 1024.0;
+    else if (unit == "m" || unit == "M") scale = 1024.0 * 1024.0;
+    else if (unit == "g" || unit == "G") scale = 1024.0 * 1024.0 * 1024.0;
+    else if (!unit.empty()) return false;
+    out = (uintmax_t)(v * scale);
+    return true;
+}
+
+void AddGlobs(std::vector<std::string>& globs, const std::string& list) {
+    std::stringstream ss(list);
+    std::string glob;
+    while (std::getline(ss, glob, ',')) if (!glob.empty()) globs.push_back(glob);
+}
+
+CompressionType DetectCompression(const char* data, size_t size) {
+    const unsigned char* b = (const unsigned char*)data;
+    if (size >= 2 && b[0] == 0x1f && b[1] == 0x8b) return COMPRESSION_GZIP;
+    if (size >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f && b[3] == 0xfd) return COMPRESSION_ZSTD;
+    return COMPRESSION_NONE;
+}
+
+bool CompressionSupported(CompressionType type) {
+    switch (type) {
+        case COMPRESSION_NONE: return true;
+#if defined(REGEX_STUDIO_ZLIB)
+        case COMPRESSION_GZIP: return true;
+#endif
+#if defined(REGEX_STUDIO_ZSTD)
+        case COMPRESSION_ZSTD: return true;
+#endif
+        default: return false;
+    }
+}
+
+class PlainReader : public ByteReader {
+public:
+    explicit PlainReader(std::ifstream&& in) : file(std::move(in)) {}
+    size_t Read(char* dst, size_t n) override {
+        file.read(dst, (std::streamsize)n);
+        size_t got = (size_t)file.gcount();
+        consumed += got;
+        return got;
+    }
+    uint64_t Consumed() const override { return consumed; }
+    bool Seek(uint64_t offset) override {
+        file.clear();
+        file.seekg((std::streamoff)offset);
+        if (!file) return false;
+        consumed = offset;
+        return true;
+    }
+
+private:
+    std::ifstream file;
+    uint64_t consumed = 0;
+};
+
+// Shared input side of the decompressors: a compressed buffer refilled from the file
+class CompressedReader : public ByteReader {
+public:
+    static const size_t INPUT_SIZE = 256 * 1024;
+    explicit CompressedReader(std::ifstream&& in) : file(std::move(in)), input(INPUT_SIZE) {}
+    uint64_t Consumed() const override { return consumed; }
+
+protected:
+    std::ifstream file;
+    std::vector<char> input;
+    size_t inputPos = 0, inputLen = 0;
+    uint64_t consumed = 0;
+
+    bool Refill() {
+        if (inputPos < inputLen) return true;
+        file.read(input.data(), (std::streamsize)input.size());
+        inputLen = (size_t)file.gcount();
+        inputPos = 0;
+        consumed += inputLen;
+        return inputLen > 0;
+    }
+};
+#if defined(REGEX_STUDIO_ZLIB)
+// gzip (and zlib) streams; concatenated members, as written by 'cat a.gz b.gz', are continued
+class GzipReader : public CompressedReader {
+public:
+    explicit GzipReader(std::ifstream&& in) : CompressedReader(std::move(in)) {
+        memset(&zs, 0, sizeof(zs));
+        if (inflateInit2(&zs, 15 + 32) != Z_OK) error = "gzip: init failed";
+    }
+    ~GzipReader() override { inflateEnd(&zs); }
+
+    size_t Read(char* dst, size_t n) override {
+        if (!error.empty() || finished) return 0;
+        zs.next_out = (Bytef*)dst;
+        zs.avail_out = (uInt)std::min<size_t>(n, UINT32_MAX);
+        while (zs.avail_out > 0) {
+            if (!Refill()) {
+                if (!memberDone) error = "gzip: truncated archive";
+                finished = true;
+                break;
+            }
+            if (memberDone) { inflateReset(&zs); memberDone = false; }
+            zs.next_in = (Bytef*)input.data() + inputPos;
+            zs.avail_in = (uInt)(inputLen - inputPos);
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            inputPos = inputLen - zs.avail_in;
+            if (rc == Z_STREAM_END) memberDone = true;
+            else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                error = std::string("gzip: ") + (zs.msg ? zs.msg : "corrupt data");
+                finished = true;
+                break;
+            }
+        }
+        return n - zs.avail_out;
+    }
+
+private:
+    z_stream zs;
+    bool memberDone = false;
+    bool finished = false;
+};
+#endif
+
+#if defined(REGEX_STUDIO_ZSTD)
+class ZstdReader : public CompressedReader {
+public:
+    explicit ZstdReader(std::ifstream&& in) : CompressedReader(std::move(in)), stream(ZSTD_createDStream()) {
+        if (!stream) error = "zstd: init failed";
+    }
+    ~ZstdReader() override { ZSTD_freeDStream(stream); }
+
+    size_t Read(char* dst, size_t n) override {
+        if (!error.empty() || finished) return 0;
+        ZSTD_outBuffer out = { dst, n, 0 };
+        while (out.pos < out.size) {
+            if (!Refill()) {
+                if (!frameDone) error = "zstd: truncated archive";
+                finished = true;
+                break;
+            }
+            ZSTD_inBuffer in = { input.data(), inputLen, inputPos };
+            size_t rc = ZSTD_decompressStream(stream, &out, &in);
+            inputPos = in.pos;
+            if (ZSTD_isError(rc)) {
+                error = std::string("zstd: ") + ZSTD_getErrorName(rc);
+                finished = true;
+                break;
+            }
+            frameDone = (rc == 0);
+        }
+        return out.pos;
+    }
+
+private:
+    ZSTD_DStream* stream;
+    bool frameDone = true;
+    bool finished = false;
+};
+#endif
+
+// DECOMPRESSION PIPELINE: The decompressor runs on its own thread and stays up to DEPTH blocks
+// ahead, so inflating block k+1 overlaps with matching block k on the scan worker.
+class PipelinedReader : public ByteReader {
+public:
+    static const size_t BLOCK_SIZE = 1024 * 1024;
+    static const size_t DEPTH = 4;
+
+    explicit PipelinedReader(std::unique_ptr<ByteReader> source) : inner(std::move(source)) {
+        thread = std::thread([this]() { Produce(); });
+    }
+    ~PipelinedReader() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        changed.notify_all();
+        thread.join();
+    }
+
+    size_t Read(char* dst, size_t n) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]() { return !ready.empty() || done; });
+        if (ready.empty()) {
+            error = inner->error;
+            return 0;
+        }
+        Block& front = ready.front();
+        size_t k = std::min(n, front.data.size() - frontPos);
+        memcpy(dst, front.data.data() + frontPos, k);
+        frontPos += k;
+        consumed = front.consumed;
+        if (frontPos == front.data.size()) {
+            ready.pop_front();
+            frontPos = 0;
+            changed.notify_all();
+        }
+        return k;
+    }
+    uint64_t Consumed() const override { return consumed; }
+
+private:
+    struct Block { std::vector<char> data; uint64_t consumed; };
+    std::unique_ptr<ByteReader> inner;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Block> ready;
+    size_t frontPos = 0;
+    uint64_t consumed = 0;
+    bool done = false;
+    bool stop = false;
+
+    void Produce() {
+        while (true) {
+            Block block;
+            block.data.resize(BLOCK_SIZE);
+            {
+                ProfileScope scope("inflate block");
+                block.data.resize(inner->ReadFull(block.data.data(), BLOCK_SIZE));
+            }
+            block.consumed = inner->Consumed();
+            std::unique_lock<std::mutex> lock(mutex);
+            if (block.data.empty() || stop) break;
+            ready.push_back(std::move(block));
+            changed.notify_all();
+            changed.wait(lock, [&]() { return ready.size() < DEPTH || stop; });
+            if (stop) break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        changed.notify_all();
+    }
+};
+
+std::unique_ptr<ByteReader> OpenByteReader(const std::filesystem::path& path, CompressionType& type) {
+    std::ifstream file(path, std::ios::binary);
+    type = COMPRESSION_NONE;
+    if (!file.is_open()) return nullptr;
+    char magic[4] = { 0, 0, 0, 0 };
+    file.read(magic, sizeof(magic));
+    type = DetectCompression(magic, (size_t)file.gcount());
+    file.clear();
+    file.seekg(0);
+    switch (type) {
+#if defined(REGEX_STUDIO_ZLIB)
+        case COMPRESSION_GZIP: return std::unique_ptr<ByteReader>(new PipelinedReader(std::unique_ptr<ByteReader>(new GzipReader(std::move(file)))));
+#endif
+#if defined(REGEX_STUDIO_ZSTD)
+        case COMPRESSION_ZSTD: return std::unique_ptr<ByteReader>(new PipelinedReader(std::unique_ptr<ByteReader>(new ZstdReader(std::move(file)))));
+#endif
+        default:
+            type = COMPRESSION_NONE; // unsupported formats are read raw (and usually sniffed as binary)
+            return std::unique_ptr<ByteReader>(new PlainReader(std::move(file)));
+    }
+}
+
+bool StatFileIdentity(const std::filesystem::path& path, FileIdentity& id) {
+#if defined(_WIN32)
+    std::error_code ec;
+    id.size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    id.mtime = (uint64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    id.inode = 0;
+    return !ec;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    id.size = (uint64_t)st.st_size;
+    #if defined(__APPLE__)
+    id.mtime = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ull + (uint64_t)st.st_mtimespec.tv_nsec;
+    #else
+    id.mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+    #endif
+    id.inode = ((uint64_t)st.st_dev << 40) ^ (uint64_t)st.st_ino;
+    return true;
+#endif
+}
+
+bool HashFileRange(const std::filesystem::path& path, uint64_t from, size_t len, uint32_t& hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::vector<char> bytes(len);
+    in.seekg((std::streamoff)from);
+    in.read(bytes.data(), (std::streamsize)len);
+    if ((size_t)in.gcount() != len) return false;
+    hash = Fnv1a(bytes.data(), len);
+    return true;
+}
+
+// ----------------------------------------------------------------------------------
+// Benchmark
+// ----------------------------------------------------------------------------------
+
+std::string FormatBenchResult(const BenchResult& r) {
+    if (!r.error.empty()) return r.engine + ": " + r.error;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s: compile %.3f ms | %.1f MB/s | %.0f matches/s | p50 %.2f us | p99 %.2f us | %llu matches",
+             r.engine.c_str(), r.compileMs, r.mbPerSec, r.matchesPerSec, r.p50Us, r.p99Us, (unsigned long long)r.matches);
+    return buf;
+}
+
+std::string CsvField(const std::string& v) {
+    if (v.find_first_of(",\"\n") == std::string::npos) return v;
+    std::string out = "\"";
+    for (char c : v) { if (c == '"') out += '"'; out += c; }
+    return out + "\"";
+}
+
+std::string JsonString(const std::string& v) {
+    std::string out = "\"";
+    for (unsigned char c : v) {
+        if (c == '"' || c == '\\') { out += '\\'; out += (char)c; }
+        else if (c < 0x20) { char esc[8]; snprintf(esc, sizeof(esc), "\\u%04x", c); out += esc; }
+        else out += (char)c;
+    }
+    return out + "\"";
+}
+
+bool WriteBenchCsv(const std::string& path, const BenchJob& job, const std::string& pattern) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "pattern,source,bytes,engine,compile_ms,mb_per_s,matches_per_s,matches,p50_us,p99_us,error\n";
+    for (const auto& r : job.results) {
+        out << CsvField(pattern) << ',' << CsvField(job.source) << ',' << job.inputSize << ',' << r.engine << ','
+            << r.compileMs << ',' << r.mbPerSec << ',' << r.matchesPerSec << ',' << r.matches << ','
+            << r.p50Us << ',' << r.p99Us << ',' << CsvField(r.error) << '\n';
+    }
+    return (bool)out;
+}
+
+bool WriteBenchJson(const std::string& path, const BenchJob& job, const std::string& pattern) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "{\n  \"pattern\": " << JsonString(pattern) << ",\n  \"source\": " << JsonString(job.source)
+        << ",\n  \"bytes\": " << job.inputSize << ",\n  \"results\": [";
+    for (size_t i = 0; i < job.results.size(); i++) {
+        const BenchResult& r = job.results[i];
+        out << (i ? ",\n" : "\n") << "    { \"engine\": " << JsonString(r.engine) << ", \"compile_ms\": " << r.compileMs
+            << ", \"mb_per_s\": " << r.mbPerSec << ", \"matches_per_s\": " << r.matchesPerSec << ", \"matches\": " << r.matches
+            << ", \"p50_us\": " << r.p50Us << ", \"p99_us\": " << r.p99Us;
+        if (!r.error.empty()) out << ", \"error\": " << JsonString(r.error);
+        out << " }";
+    }
+    out << "\n  ]\n}\n";
+    return (bool)out;
+}
+
+bool WriteChromeTrace(const std::string& path, const std::vector<TraceEvent>& events) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    char num[64];
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    std::set<int> threads;
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& e = events[i];
+        threads.insert(e.tid);
+        snprintf(num, sizeof(num), "%.3f, \"dur\": %.3f", e.ts, e.dur);
+        out << (i ? ",\n" : "\n") << "{\"name\": " << JsonString(e.name) << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.tid << ", \"ts\": " << num;
+        if (!e.detail.empty()) out << ", \"args\": {\"detail\": " << JsonString(e.detail) << "}";
+        out << "}";
+    }
+    for (int tid : threads) {
+        std::string name = tid == 0 ? "render" : "thread " + std::to_string(tid);
+        out << (events.empty() ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << tid
+            << ", \"args\": {\"name\": " << JsonString(name) << "}}";
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
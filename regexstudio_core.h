@@ -0,0 +1,2777 @@
+/**
+ * REGEX STUDIO CORE
+ * Everything the editor runs that does not draw: the node/template vocabulary, the regex
+ * engines (std / lazy DFA / Pike VM), literal prefilters, the file scanner with its cache,
+ * the playground piece table, the benchmark job and the profiler. No raylib dependency,
+ * so the bench target (and any other tool) links it without a window.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include <regex> 
+#include <fstream>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <memory>
+#include <functional>
+#include <bitset>
+#include <unordered_map>
+#include <unordered_set>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <chrono>
+#include <condition_variable>
+#include <optional>
+
+#if defined(_WIN32)
+    // Keep windows.h from clashing with raylib (Rectangle, CloseWindow, DrawText...) and std::min/max
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// SIMD literal search (AVX2 is picked at runtime, SSE2 is the x86 baseline)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define REGEX_STUDIO_X86_SIMD 1
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+// ----------------------------------------------------------------------------------
+// Profiler
+// ----------------------------------------------------------------------------------
+
+extern thread_local uint64_t threadAllocations; // allocations made by this thread, see ALLOCATION COUNTER (main.cpp)
+
+enum ProfileZone { PROF_GRAPH, PROF_COMPILE, PROF_MATCH, PROF_LAYOUT, PROF_DRAW, PROF_ZONE_COUNT };
+const char* const PROFILE_ZONE_NAMES[PROF_ZONE_COUNT] = { "graph", "compile", "match", "layout", "draw" };
+const size_t PROFILE_HISTORY = 240;        // frames kept for the overlay graph
+const size_t TRACE_MAX_EVENTS = 1000000;   // recording stops here (~100 MB of JSON)
+
+struct TraceEvent {
+    const char* name;
+    std::string detail; // shown as args.detail in the trace viewer
+    int tid;
+    double ts, dur;     // microseconds since the profiler started
+};
+
+struct FrameProfile {
+    float zoneMs[PROF_ZONE_COUNT] = {};
+    float totalMs = 0;
+    uint32_t allocations = 0;
+};
+
+// PROFILER: Zones accumulate exclusive time (nested zones are subtracted from their parent) on
+// the render thread for the F3 overlay; every thread can add events to a Chrome trace recording.
+class Profiler {
+public:
+    Profiler() : renderThread(std::this_thread::get_id()), epoch(std::chrono::steady_clock::now()), history(PROFILE_HISTORY) {}
+
+    double NowUs() const { return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count(); }
+    bool OnRenderThread() const { return std::this_thread::get_id() == renderThread; }
+    bool Tracing() const { return tracing.load(std::memory_order_relaxed); }
+
+    // Render thread, once per frame: closes the record of the previous frame
+    void BeginFrame() {
+        double now = NowUs();
+        if (frameStart > 0) {
+            FrameProfile& f = history[next];
+            for (int z = 0; z < PROF_ZONE_COUNT; z++) f.zoneMs[z] = (float)(zoneUs[z] / 1000.0);
+            f.totalMs = (float)((now - frameStart) / 1000.0);
+            f.allocations = (uint32_t)(threadAllocations - frameAllocations);
+            next = (next + 1) % history.size();
+            if (filled < history.size()) filled++;
+            if (Tracing()) AddEvent("frame", std::string(), frameStart, now - frameStart);
+        }
+        for (double& z : zoneUs) z = 0;
+        frameStart = now;
+        frameAllocations = threadAllocations;
+    }
+
+    void AddZoneTime(ProfileZone zone, double us) { zoneUs[zone] += us; }
+
+    void AddEvent(const char* name, std::string detail, double ts, double dur) {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        if (!Tracing()) return;
+        if (events.size() >= TRACE_MAX_EVENTS) { tracing = false; truncated = true; return; }
+        events.push_back({ name, std::move(detail), ThreadId(), ts, dur });
+    }
+
+    void StartTrace() {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        events.clear();
+        truncated = false;
+        tracing = true;
+    }
+
+    // Ends the recording and hands the events over; 'wasTruncated' reports the event cap
+    void StopTrace(std::vector<TraceEvent>& out, bool& wasTruncated) {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        tracing = false;
+        out.swap(events);
+        events.clear();
+        wasTruncated = truncated;
+    }
+
+    // k = 0 is the last complete frame
+    const FrameProfile* Frame(size_t k) const {
+        if (k >= filled) return nullptr;
+        return &history[(next + history.size() - 1 - k) % history.size()];
+    }
+    size_t FrameCount() const { return filled; }
+
+private:
+    std::thread::id renderThread;
+    std::chrono::steady_clock::time_point epoch;
+    double frameStart = 0;
+    uint64_t frameAllocations = 0;
+    double zoneUs[PROF_ZONE_COUNT] = {};
+    std::vector<FrameProfile> history;
+    size_t next = 0, filled = 0;
+    std::atomic<bool> tracing{ false };
+    bool truncated = false;
+    std::mutex traceMutex;
+    std::vector<TraceEvent> events;
+
+    // Small stable ids for the trace viewer: 0 is the render thread
+    int ThreadId() const {
+        static std::atomic<int> nextId{ 1 };
+        thread_local int id = -1;
+        if (id < 0) id = OnRenderThread() ? 0 : nextId++;
+        return id;
+    }
+};
+
+extern Profiler profiler;
+
+// Times the enclosing block. Zone scopes feed the overlay (render thread only); every scope
+// becomes a trace event while a recording runs. Attach 'detail' only when Tracing() is true.
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileZone z) : name(PROFILE_ZONE_NAMES[z]), zone(z), start(profiler.NowUs()) {
+        if (profiler.OnRenderThread()) { parent = openZone; openZone = this; }
+    }
+    // 'busyUs' (optional) accumulates the elapsed time, e.g. a scan worker's utilization
+    explicit ProfileScope(const char* traceName, std::atomic<uint64_t>* busyUs = nullptr) : name(traceName), start(profiler.NowUs()), busy(busyUs) {}
+    ~ProfileScope() {
+        double elapsed = profiler.NowUs() - start;
+        if (busy) *busy += (uint64_t)elapsed;
+        if (openZone == this) {
+            profiler.AddZoneTime((ProfileZone)zone, elapsed - childUs);
+            if (parent) parent->childUs += elapsed;
+            openZone = parent;
+        }
+        if (profiler.Tracing()) profiler.AddEvent(name, std::move(detail), start, elapsed);
+    }
+    bool Tracing() const { return profiler.Tracing(); }
+
+    std::string detail;
+
+private:
+    const char* name;
+    int zone = -1;
+    double start;
+    double childUs = 0;
+    std::atomic<uint64_t>* busy = nullptr;
+    ProfileScope* parent = nullptr;
+    static thread_local ProfileScope* openZone;
+};
+// ----------------------------------------------------------------------------------
+// Graph Vocabulary
+// ----------------------------------------------------------------------------------
+
+enum NodeType {
+    NODE_START, NODE_END,
+    NODE_TEXT, NODE_DIGIT, NODE_WHITESPACE,
+    NODE_ANY, NODE_WORD, NODE_SYMBOL, NODE_CUSTOM,
+    NODE_NOT_DIGIT, NODE_NOT_WHITESPACE, NODE_NOT_WORD,
+    NODE_ZERO_OR_MORE, NODE_ONE_OR_MORE, NODE_OPTIONAL,
+    NODE_GROUP_START, NODE_GROUP_END, NODE_OR
+};
+
+enum TemplateType { TPL_EMAIL, TPL_DATE_ISO, TPL_PHONE_US, TPL_URL_SIMPLE, TPL_IP_V4, TPL_COUNT };
+
+// Palette title and regex fragment of a fresh node (the UI adds geometry and colour)
+struct NodeDefaults {
+    const char* title;
+    const char* regexValue;
+};
+
+NodeDefaults DefaultNode(NodeType type);
+
+// PRESET TEMPLATES: One chained node per step; a non-empty 'value' replaces the fragment (and
+// the title) of a NODE_CUSTOM step. The canvas builds these, the benchmarks match them.
+struct TemplateStep {
+    NodeType type;
+    const char* value;
+};
+
+std::vector<TemplateStep> TemplateSteps(TemplateType type);
+
+// The pattern the template's chain generates: its fragments in order, as GenerateRegex joins them
+std::string TemplateRegex(TemplateType type);
+
+const char* TemplateName(TemplateType type);
+
+struct Connection {
+    int fromNodeId;
+    int toNodeId;
+};
+
+// PROJECT FILES: VREGEX_2 (default) is little-endian binary, loaded with one read or mmap:
+//   header   "VREGEX_2" | u32 flags | u32 nodes | u32 connections | u32 string bytes | i32 nextNodeId | u32 checksum
+//   nodes    i32 id | i32 type | f32 x | f32 y | u8 rgba[4] | u32 title off, len | u32 value off, len
+//   conns    i32 from | i32 to
+//   strings  titles and values, referenced by (offset, length)
+// The checksum (FNV-1a over everything after the header) is verified when VREGEX_FLAG_CHECKSUM is set.
+// The editor keeps VREGEX_1.0, the original text format ('save --text').
+const char VREGEX_MAGIC[8] = { 'V', 'R', 'E', 'G', 'E', 'X', '_', '2' };
+const uint32_t VREGEX_FLAG_CHECKSUM = 1;
+const size_t VREGEX_HEADER_SIZE = 32;
+const size_t VREGEX_NODE_SIZE = 36;
+const size_t VREGEX_CONN_SIZE = 8;
+
+// One node record as the file stores it; the editor adds the size and UI state. Decoded strings
+// point into the file buffer, so they are only valid while it is.
+struct ProjectNode {
+    int id;
+    NodeType type;
+    float x, y;
+    unsigned char rgba[4];
+    std::string_view title;
+    std::string_view regexValue;
+};
+
+std::string EncodeProjectBinary(const std::vector<ProjectNode>& nodes, const std::vector<Connection>& connections, int nextNodeId);
+
+// Every count, offset and length is checked against the file size before it is used
+bool DecodeProjectBinary(const char* data, size_t size, std::vector<ProjectNode>& outNodes, std::vector<Connection>& outConns, int& outNextId, std::string& error);
+
+// REGEX IMPORT: One left-to-right pass splits a pattern into node-sized tokens (spans into the
+// source string, no per-token allocation). Chaining one node per token, with ImportedFragment as
+// the value, generates the input again.
+struct ImportToken {
+    NodeType type;
+    size_t begin, len; // span in the source pattern
+    int depth;         // group nesting, for the layout
+};
+
+bool TokenizeRegex(const std::string& re, std::vector<ImportToken>& out, std::string& error);
+
+// The node value for a token: its span for NODE_CUSTOM, the palette fragment (the same text) otherwise
+std::string_view ImportedFragment(const ImportToken& tok, std::string_view re);
+
+// ----------------------------------------------------------------------------------
+// Regex Engine Layer
+// ----------------------------------------------------------------------------------
+
+// ENGINE BACKENDS: "std" = <regex> (full ECMAScript), "dfa" = in-house lazy DFA,
+// "auto" = dfa when the pattern only uses supported syntax and has no loop whose body can
+// match empty (see EMPTY LOOPS), std otherwise.
+enum EngineType { ENGINE_STD, ENGINE_DFA, ENGINE_AUTO };
+
+struct EngineMatch {
+    size_t start;
+    size_t length;
+    std::vector<std::pair<long, long>> groups; // (start, length), start = -1 if the group did not participate
+};
+
+// MATCH BUDGET: Work one search may do before it is aborted, so a catastrophic pattern fails
+// instead of hanging. The allowance grows with the distance the search has advanced, which keeps
+// long linear scans legal while a search that backtracks in place runs out.
+struct MatchBudget {
+    uint64_t baseSteps = 4000000;
+    uint64_t stepsPerByte = 512;
+};
+
+class MatchBudgetExceeded : public std::runtime_error {
+public:
+    MatchBudgetExceeded(double ms, size_t off) : std::runtime_error("match budget exceeded"), millis(ms), offset(off) {}
+    double millis;
+    size_t offset; // where the aborted search started, relative to the buffer passed to ForEach
+};
+
+std::string FormatMatchAbort(const MatchBudgetExceeded& e, size_t base = 0);
+
+class RegexEngine {
+public:
+    MatchBudget budget; // enforced by backtracking backends; the DFA backend is linear-time
+
+    virtual ~RegexEngine() {}
+    virtual const char* Name() const = 0;
+    virtual bool Compile(const std::string& pattern, std::string& error) = 0;
+
+    // Calls fn for every non-overlapping match in [begin, end), searching from begin + from.
+    // Returning false from fn stops the iteration. Not thread safe: use one engine per thread.
+    virtual void ForEach(const char* begin, const char* end, size_t from, bool wantGroups,
+                         const std::function<bool(const EngineMatch&)>& fn) = 0;
+
+    virtual size_t Count(const char* begin, const char* end) {
+        size_t n = 0;
+        ForEach(begin, end, 0, false, [&](const EngineMatch&) { n++; return true; });
+        return n;
+    }
+};
+
+// STD BACKEND (Compatibility: exact std::regex ECMAScript semantics)
+class StdRegexEngine : public RegexEngine {
+public:
+    const char* Name() const override { return "std"; }
+
+    bool Compile(const std::string& pattern, std::string& error) override {
+        try { re = std::regex(pattern); return true; }
+        catch (const std::exception& e) { error = e.what(); return false; }
+    }
+
+    void ForEach(const char* begin, const char* end, size_t from, bool wantGroups,
+                 const std::function<bool(const EngineMatch&)>& fn) override {
+        Meter meter(budget, begin);
+        meter.Reset(begin + from);
+        auto flags = from > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+        std::regex_iterator<MeteredIter> it(MeteredIter(begin + from, &meter), MeteredIter(end, &meter), re, flags), itEnd;
+        EngineMatch m;
+        for (; it != itEnd;) {
+            const std::match_results<MeteredIter>& cm = *it;
+            // Offsets from the raw pointers: position()/length() would walk the bidirectional iterator
+            m.start = cm[0].first.p - begin;
+            m.length = cm[0].second.p - cm[0].first.p;
+            m.groups.clear();
+            if (wantGroups) {
+                for (size_t k = 1; k < cm.size(); ++k) {
+                    if (cm[k].matched) m.groups.push_back({ (long)(cm[k].first.p - begin), (long)(cm[k].second.p - cm[k].first.p) });
+                    else m.groups.push_back({ -1, 0 });
+                }
+            }
+            if (!fn(m)) break;
+            meter.Reset(cm[0].second.p); // every search gets its own allowance
+            ++it;
+        }
+    }
+
+private:
+    std::regex re;
+
+    // Counts every iterator move std::regex makes; the backtracking executor walks the input
+    // only through these, so the count bounds its work
+    struct Meter {
+        const MatchBudget& budget;
+        const char* base;
+        const char* searchStart = nullptr;
+        const char* farthest = nullptr;
+        uint64_t steps = 0, limit = 0;
+        std::chrono::steady_clock::time_point started;
+
+        Meter(const MatchBudget& b, const char* bufferBegin) : budget(b), base(bufferBegin) {}
+        void Reset(const char* at) {
+            searchStart = farthest = at;
+            steps = 0;
+            limit = budget.baseSteps;
+            started = std::chrono::steady_clock::now();
+        }
+        void Tick(const char* p) {
+            if (p > farthest) { limit += budget.stepsPerByte * (uint64_t)(p - farthest); farthest = p; }
+            if (++steps > limit) {
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+                throw MatchBudgetExceeded(ms, (size_t)(searchStart - base));
+            }
+        }
+    };
+
+    struct MeteredIter {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        const char* p = nullptr;
+        Meter* meter = nullptr;
+
+        MeteredIter() {}
+        MeteredIter(const char* at, Meter* m) : p(at), meter(m) {}
+        reference operator*() const { return *p; }
+        pointer operator->() const { return p; }
+        MeteredIter& operator++() { ++p; meter->Tick(p); return *this; }
+        MeteredIter operator++(int) { MeteredIter t = *this; ++*this; return t; }
+        MeteredIter& operator--() { --p; meter->Tick(p); return *this; }
+        MeteredIter operator--(int) { MeteredIter t = *this; --*this; return t; }
+        bool operator==(const MeteredIter& o) const { return p == o.p; }
+        bool operator!=(const MeteredIter& o) const { return p != o.p; }
+    };
+};
+
+// DFA BACKEND: Parser -> AST -> Thompson NFA program.
+// A forward leftmost-first lazy DFA finds where the match ends, a reverse DFA finds where it
+// starts, and a Pike VM only runs over the matched span when capture groups are requested.
+// Loops whose body can match empty do not follow ECMAScript's empty-iteration rule (EMPTY LOOPS).
+enum ReNodeType { RE_EMPTY, RE_SET, RE_CAT, RE_ALT, RE_REPEAT, RE_GROUP, RE_BOL, RE_EOL };
+
+struct ReNode {
+    ReNodeType type = RE_EMPTY;
+    int set = -1;         // RE_SET: index into the byte set table
+    int min = 0;          // RE_REPEAT: bounds, max = -1 means unbounded
+    int max = 0;
+    bool greedy = true;
+    int capture = -1;     // RE_GROUP: capture index, -1 for (?:...)
+    size_t from = 0;      // source range [from, to) in the pattern
+    size_t to = 0;
+    std::vector<ReNode> kids;
+};
+
+enum ReOp { OP_CHAR, OP_SPLIT, OP_JMP, OP_SAVE, OP_BOL, OP_EOL, OP_MATCH };
+
+struct ReInst {
+    ReOp op;
+    int x; // CHAR: set, SPLIT/JMP: preferred target, SAVE: slot
+    int y; // SPLIT: fallback target
+};
+
+struct ReProg {
+    std::vector<ReInst> insts;
+    int start = 0;
+};
+
+typedef std::bitset<256> ByteSet;
+
+const int RE_MAX_REPEAT = 1000;
+const size_t RE_MAX_INSTS = 200000;
+
+class ReParser {
+public:
+    // lenient: accept std-only syntax approximately (lookaround as a group, \b as empty,
+    // backreferences as any byte) for analyses that do not need to compile the pattern
+    ReParser(const std::string& pattern, std::vector<ByteSet>& sets, bool lenient = false) : s(pattern), sets(sets), lenient(lenient) {}
+
+    ReNode Parse() {
+        ReNode root = ParseAlt();
+        if (i < s.size()) Fail("unmatched ')'");
+        return root;
+    }
+
+    int captureCount = 0;
+
+private:
+    const std::string& s;
+    std::vector<ByteSet>& sets;
+    bool lenient;
+    size_t i = 0;
+
+    [[noreturn]] void Fail(const std::string& msg) {
+        throw std::runtime_error(msg + " at offset " + std::to_string(i));
+    }
+
+    bool More() const { return i < s.size(); }
+
+    ReNode SetNode(const ByteSet& b) {
+        ReNode n; n.type = RE_SET; n.set = (int)sets.size();
+        sets.push_back(b);
+        return n;
+    }
+
+    ReNode ParseAlt() {
+        size_t start = i;
+        ReNode first = ParseCat();
+        if (!More() || s[i] != '|') return first;
+        ReNode alt; alt.type = RE_ALT;
+        alt.kids.push_back(first);
+        while (More() && s[i] == '|') { i++; alt.kids.push_back(ParseCat()); }
+        alt.from = start; alt.to = i;
+        return alt;
+    }
+
+    ReNode ParseCat() {
+        size_t start = i;
+        ReNode cat; cat.type = RE_CAT;
+        while (More() && s[i] != '|' && s[i] != ')') cat.kids.push_back(ParseRepeat());
+        if (cat.kids.empty()) { ReNode empty; empty.from = empty.to = start; return empty; }
+        if (cat.kids.size() == 1) return cat.kids[0];
+        cat.from = start; cat.to = i;
+        return cat;
+    }
+
+    bool ParseNumber(int& out) {
+        size_t startPos = i;
+        long v = 0;
+        while (More() && isdigit((unsigned char)s[i])) { v = v * 10 + (s[i] - '0'); if (v > 100000) v = 100000; i++; }
+        out = (int)v;
+        return i > startPos;
+    }
+
+    ReNode ParseRepeat() {
+        size_t start = i;
+        ReNode atom = ParseAtom();
+        atom.from = start; atom.to = i;
+        if (!More()) return atom;
+        int min = 0, max = 0;
+        char q = s[i];
+        if (q == '*') { min = 0; max = -1; i++; }
+        else if (q == '+') { min = 1; max = -1; i++; }
+        else if (q == '?') { min = 0; max = 1; i++; }
+        else if (q == '{') {
+            i++;
+            if (!ParseNumber(min)) Fail("invalid brace quantifier");
+            max = min;
+            if (More() && s[i] == ',') {
+                i++;
+                if (!ParseNumber(max)) max = -1;
+            }
+            if (!More() || s[i] != '}') Fail("invalid brace quantifier");
+            i++;
+            if (max != -1 && max < min) Fail("invalid repeat range");
+            if (!lenient && (min > RE_MAX_REPEAT || max > RE_MAX_REPEAT)) Fail("repeat count too large for dfa");
+        }
+        else return atom;
+
+        if (atom.type == RE_BOL || atom.type == RE_EOL) Fail("nothing to repeat");
+        ReNode rep; rep.type = RE_REPEAT; rep.min = min; rep.max = max;
+        if (More() && s[i] == '?') { rep.greedy = false; i++; }
+        rep.kids.push_back(atom);
+        if (More() && (s[i] == '*' || s[i] == '+' || s[i] == '?' || s[i] == '{')) Fail("nothing to repeat");
+        rep.from = start; rep.to = i;
+        return rep;
+    }
+
+    ReNode ParseAtom() {
+        char c = s[i];
+        switch (c) {
+            case '(': {
+                i++;
+                ReNode grp; grp.type = RE_GROUP;
+                if (More() && s[i] == '?') {
+                    if (i + 1 < s.size() && s[i + 1] == ':') i += 2;
+                    else if (lenient && s.compare(i, 3, "?<=") == 0) i += 3;
+                    else if (lenient && s.compare(i, 3, "?<!") == 0) i += 3;
+                    else if (lenient && i + 1 < s.size() && (s[i + 1] == '=' || s[i + 1] == '!')) i += 2;
+                    else Fail("lookaround is not supported by dfa");
+                } else {
+                    grp.capture = ++captureCount;
+                }
+                grp.kids.push_back(ParseAlt());
+                if (!More() || s[i] != ')') Fail("missing ')'");
+                i++;
+                return grp;
+            }
+            case '[': { i++; return SetNode(ParseClass()); }
+            case '.': {
+                i++;
+                ByteSet b; b.set(); b.reset('\n'); b.reset('\r');
+                return SetNode(b);
+            }
+            case '^': { i++; ReNode n; n.type = RE_BOL; return n; }
+            case '$': { i++; ReNode n; n.type = RE_EOL; return n; }
+            case '\\': {
+                i++;
+                if (lenient && More() && (s[i] == 'b' || s[i] == 'B')) { i++; return ReNode(); }
+                if (lenient && More() && s[i] >= '1' && s[i] <= '9') {
+                    while (More() && isdigit((unsigned char)s[i])) i++;
+                    ByteSet any; any.set();
+                    return SetNode(any);
+                }
+                ByteSet b;
+                ParseEscape(b, false);
+                return SetNode(b);
+            }
+            case '*': case '+': case '?': case '{': Fail("nothing to repeat");
+            default: {
+                i++;
+                ByteSet b; b.set((unsigned char)c);
+                return SetNode(b);
+            }
+        }
+    }
+
+    static int HexVal(char h) {
+        if (h >= '0' && h <= '9') return h - '0';
+        if (h >= 'a' && h <= 'f') return h - 'a' + 10;
+        if (h >= 'A' && h <= 'F') return h - 'A' + 10;
+        return -1;
+    }
+
+    // Parses the escape after '\'. Returns the literal byte, or -1 if it was a class escape (\d, \w ...).
+    int ParseEscape(ByteSet& b, bool inClass) {
+        if (!More()) Fail("trailing backslash");
+        char c = s[i++];
+        ByteSet digit, word, space;
+        for (int k = '0'; k <= '9'; k++) digit.set(k);
+        word = digit;
+        for (int k = 'a'; k <= 'z'; k++) { word.set(k); word.set(k - 'a' + 'A'); }
+        word.set('_');
+        for (char k : std::string(" \t\n\v\f\r")) space.set((unsigned char)k);
+
+        int lit = -1;
+        switch (c) {
+            case 'd': b |= digit; return -1;
+            case 'D': b |= ~digit; return -1;
+            case 'w': b |= word; return -1;
+            case 'W': b |= ~word; return -1;
+            case 's': b |= space; return -1;
+            case 'S': b |= ~space; return -1;
+            case 't': lit = '\t'; break;
+            case 'n': lit = '\n'; break;
+            case 'r': lit = '\r'; break;
+            case 'f': lit = '\f'; break;
+            case 'v': lit = '\v'; break;
+            case '0': lit = 0; break;
+            case 'b':
+                if (!inClass) Fail("word boundary is not supported by dfa");
+                lit = '\b'; break;
+            case 'B': Fail("word boundary is not supported by dfa");
+            case 'x': case 'u': {
+                int digits = (c == 'x') ? 2 : 4;
+                int v = 0;
+                for (int k = 0; k < digits; k++) {
+                    if (!More() || HexVal(s[i]) < 0) Fail("invalid hex escape");
+                    v = v * 16 + HexVal(s[i++]);
+                }
+                if (v > 0xFF) Fail("non-latin1 escape is not supported by dfa");
+                lit = v; break;
+            }
+            default:
+                if (c >= '1' && c <= '9') Fail("backreferences are not supported by dfa");
+                lit = (unsigned char)c; break;
+        }
+        b.set(lit);
+        return lit;
+    }
+
+    ByteSet ParseClass() {
+        ByteSet b;
+        bool negate = false;
+        if (More() && s[i] == '^') { negate = true; i++; }
+        while (true) {
+            if (!More()) Fail("missing ']'");
+            if (s[i] == ']') { i++; break; }
+            ByteSet item;
+            int lo;
+            if (s[i] == '\\') {
+                i++;
+                lo = ParseEscape(item, true);
+            } else {
+                lo = (unsigned char)s[i++];
+                item.set(lo);
+            }
+            if (lo >= 0 && i + 1 < s.size() && s[i] == '-' && s[i + 1] != ']') {
+                i++;
+                int hi;
+                if (s[i] == '\\') {
+                    i++;
+                    ByteSet tmp;
+                    hi = ParseEscape(tmp, true);
+                    if (hi < 0) Fail("invalid class range");
+                } else hi = (unsigned char)s[i++];
+                if (hi < lo) Fail("invalid class range");
+                for (int k = lo; k <= hi; k++) item.set(k);
+            }
+            b |= item;
+        }
+        if (negate) b.flip();
+        return b;
+    }
+};
+
+// Emits NFA code for n. In reverse mode concatenations are flipped and ^/$ swap roles,
+// which yields a program matching the reversed language (used to find match starts).
+void ReEmit(const ReNode& n, ReProg& prog, bool reverse);
+
+void ReCompile(const ReNode& root, ReProg& prog, bool reverse);
+
+// LAZY DFA: States are built on demand from NFA thread lists and cached with a 256-entry
+// transition row. In leftmost-first mode thread order encodes priority (like backtracking),
+// in longest mode the lists are plain sets.
+struct DfaTables {
+    int stateCount = 0;
+    std::vector<int> trans;            // stateCount * 256
+    std::vector<unsigned char> flags;  // DFA_FLAG_* per state
+    int start[8] = { -1, -1, -1, -1, -1, -1, -1, -1 }; // [bol][unanchored][notNull], -1 = not built
+};
+
+const unsigned char DFA_FLAG_MATCH = 1;
+const unsigned char DFA_FLAG_DEAD = 2;
+const unsigned char DFA_FLAG_EOF_MATCH = 4; // matches when the input ends in this state
+
+class LazyDfa {
+public:
+    void Init(const ReProg* p, const std::vector<ByteSet>* s, bool leftmostFirstMode) {
+        prog = p; sets = s; leftmostFirst = leftmostFirstMode;
+        mark.assign(prog->insts.size(), 0);
+        Reset();
+    }
+
+    // End of the leftmost-first match beginning at or after 'from', or -1 if there is none.
+    // notNull: anchored at 'from' and an empty match is not acceptable (std iterator retry rule).
+    long FindEnd(const unsigned char* text, size_t len, size_t from, bool notNull = false) {
+        int s = StartState(from == 0, !notNull, notNull);
+        long last = matchFlag[s] ? (long)from : -1;
+        size_t p = from;
+        for (; p < len; p++) {
+            if (deadFlag[s]) return last;
+            int n = trans[(size_t)s * 256 + text[p]];
+            if (n < 0) n = Step(s, text[p]);
+            s = n;
+            if (matchFlag[s]) last = (long)p + 1;
+        }
+        if (!deadFlag[s] && (!notNull || len > from) && EofMatch(s, len == 0)) last = (long)len;
+        return last;
+    }
+
+    // Smallest start in [limit, end] so that [start, end) matches. Runs the reverse program.
+    long FindStart(const unsigned char* text, size_t len, size_t end, size_t limit) {
+        int s = StartState(end == len, false, false);
+        long best = matchFlag[s] ? (long)end : -1;
+        size_t p = end;
+        for (; p > limit; p--) {
+            if (deadFlag[s]) return best;
+            int n = trans[(size_t)s * 256 + text[p - 1]];
+            if (n < 0) n = Step(s, text[p - 1]);
+            s = n;
+            if (matchFlag[s]) best = (long)p - 1;
+        }
+        if (limit == 0 && !deadFlag[s] && EofMatch(s, len == 0)) best = 0;
+        return best;
+    }
+
+    // Builds every state reachable from the start slots in slotMask (bit = [bol][unanchored][notNull]).
+    // Used for code generation; false if the automaton needs more than maxStates states.
+    bool Materialize(unsigned slotMask, size_t maxStates, DfaTables& out) {
+        Reset();
+        if (maxStates >= MAX_STATES) maxStates = MAX_STATES - 1; // never let Step flush the cache
+        for (int slot = 0; slot < 8; slot++) {
+            if (slotMask & (1u << slot)) out.start[slot] = StartState((slot & 4) != 0, (slot & 2) != 0, (slot & 1) != 0);
+        }
+        for (size_t s = 0; s < states.size(); s++) {
+            for (int c = 0; c < 256; c++) {
+                if (trans[s * 256 + c] >= 0) continue;
+                if (states.size() >= maxStates) return false;
+                Step((int)s, (unsigned char)c);
+            }
+        }
+        out.stateCount = (int)states.size();
+        out.trans = trans;
+        out.flags.resize(states.size());
+        for (size_t s = 0; s < states.size(); s++) {
+            out.flags[s] = (matchFlag[s] ? DFA_FLAG_MATCH : 0) | (deadFlag[s] ? DFA_FLAG_DEAD : 0) | (EofMatch((int)s) ? DFA_FLAG_EOF_MATCH : 0);
+        }
+        return true;
+    }
+
+private:
+    struct State {
+        std::vector<int> insts; // pending OP_CHAR / OP_EOL pcs
+        bool match;
+        bool starts;            // unanchored search may still begin new threads
+    };
+
+    static const size_t MAX_STATES = 4096;
+
+    const ReProg* prog = nullptr;
+    const std::vector<ByteSet>* sets = nullptr;
+    bool leftmostFirst = true;
+    std::vector<State> states;
+    std::unordered_map<std::string, int> index;
+    std::vector<int> trans;
+    std::vector<unsigned char> matchFlag;
+    std::vector<unsigned char> deadFlag;
+    std::vector<int> startStates; // [bol][unanchored][notNull]
+    std::vector<unsigned int> mark;
+    unsigned int markGen = 0;
+    std::vector<int> stack;
+
+    void Reset() {
+        states.clear(); index.clear(); trans.clear(); matchFlag.clear(); deadFlag.clear();
+        startStates.assign(8, -1);
+    }
+
+    // Follows epsilon edges from pc, appending consuming/pending pcs to out in priority order
+    void AddThread(std::vector<int>& out, int pc, bool bol, bool eol, bool& matched, bool ignoreMatch = false) {
+        stack.clear();
+        stack.push_back(pc);
+        while (!stack.empty()) {
+            int cur = stack.back(); stack.pop_back();
+            if (mark[cur] == markGen) continue;
+            mark[cur] = markGen;
+            const ReInst& in = prog->insts[cur];
+            switch (in.op) {
+                case OP_CHAR: out.push_back(cur); break;
+                case OP_MATCH:
+                    if (ignoreMatch) break;
+                    matched = true;
+                    if (leftmostFirst) { stack.clear(); return; }
+                    break;
+                case OP_JMP: stack.push_back(in.x); break;
+                case OP_SPLIT: stack.push_back(in.y); stack.push_back(in.x); break;
+                case OP_SAVE: stack.push_back(cur + 1); break;
+                case OP_BOL: if (bol) stack.push_back(cur + 1); break;
+                case OP_EOL:
+                    if (eol) stack.push_back(cur + 1);
+                    else out.push_back(cur);
+                    break;
+            }
+        }
+    }
+
+    void NextGen() {
+        if (++markGen == 0) { std::fill(mark.begin(), mark.end(), 0); markGen = 1; }
+    }
+
+    int AddState(std::vector<int>& insts, bool match, bool starts) {
+        if (!leftmostFirst) std::sort(insts.begin(), insts.end());
+        std::string key((const char*)insts.data(), insts.size() * sizeof(int));
+        key += (char)(match ? 1 : 0);
+        key += (char)(starts ? 1 : 0);
+        auto it = index.find(key);
+        if (it != index.end()) return it->second;
+        int id = (int)states.size();
+        states.push_back({ insts, match, starts });
+        index[key] = id;
+        trans.resize(trans.size() + 256, -1);
+        matchFlag.push_back(match ? 1 : 0);
+        deadFlag.push_back(insts.empty() && !starts ? 1 : 0);
+        return id;
+    }
+
+    int StartState(bool bol, bool unanchored, bool notNull) {
+        int slot = (bol ? 4 : 0) + (unanchored ? 2 : 0) + (notNull ? 1 : 0);
+        if (startStates[slot] >= 0) return startStates[slot];
+        if (states.size() >= MAX_STATES) Reset();
+        NextGen();
+        std::vector<int> insts;
+        bool matched = false;
+        AddThread(insts, prog->start, bol, false, matched, notNull);
+        int id = AddState(insts, matched, unanchored);
+        startStates[slot] = id;
+        return id;
+    }
+
+    int Step(int s, unsigned char c) {
+        if (states.size() >= MAX_STATES) {
+            // Cache full: flush everything but the state we are standing on
+            State keep = states[s];
+            Reset();
+            s = AddState(keep.insts, keep.match, keep.starts);
+        }
+        NextGen();
+        std::vector<int> next;
+        bool matched = false;
+        const std::vector<int> curInsts = states[s].insts; // AddState may reallocate states
+        bool curMatch = states[s].match, curStarts = states[s].starts;
+        for (int pc : curInsts) {
+            const ReInst& in = prog->insts[pc];
+            if (in.op != OP_CHAR || !(*sets)[in.x].test(c)) continue;
+            AddThread(next, pc + 1, false, false, matched);
+            if (matched && leftmostFirst) break;
+        }
+        bool starts = curStarts && !curMatch;
+        if (starts && !(matched && leftmostFirst)) AddThread(next, prog->start, false, false, matched);
+        int id = AddState(next, matched, starts);
+        trans[(size_t)s * 256 + c] = id;
+        return id;
+    }
+
+    // bol: the end of input is also its start (empty input), so a '^' after a pending '$' holds
+    bool EofMatch(int s, bool bol = false) {
+        if (states[s].match) return true;
+        NextGen();
+        std::vector<int> dummy;
+        bool matched = false;
+        for (int pc : states[s].insts) {
+            if (prog->insts[pc].op == OP_EOL) AddThread(dummy, pc + 1, bol, true, matched);
+            if (matched) return true;
+        }
+        return false;
+    }
+};
+
+// PIKE VM: Leftmost-first NFA simulation with capture slots, used only for group extraction
+bool PikeMatch(const ReProg& prog, const std::vector<ByteSet>& sets, int slots,
+               const unsigned char* text, size_t len, size_t start, bool notNull, std::vector<long>& outCaps);
+
+class DfaRegexEngine : public RegexEngine {
+public:
+    const char* Name() const override { return "dfa"; }
+
+    bool Compile(const std::string& pattern, std::string& error) override {
+        try {
+            sets.clear();
+            ReParser parser(pattern, sets);
+            ReNode root = parser.Parse();
+            captureCount = parser.captureCount;
+            ReCompile(root, forwardProg, false);
+            ReCompile(root, reverseProg, true);
+            forward.Init(&forwardProg, &sets, true);
+            reverse.Init(&reverseProg, &sets, false);
+            return true;
+        } catch (const std::exception& e) { error = e.what(); return false; }
+    }
+
+    void ForEach(const char* begin, const char* end, size_t from, bool wantGroups,
+                 const std::function<bool(const EngineMatch&)>& fn) override {
+        const unsigned char* text = (const unsigned char*)begin;
+        size_t len = end - begin;
+        EngineMatch m;
+        std::vector<long> caps;
+        size_t pos = from;
+        bool retryNotNull = false;
+        while (pos <= len) {
+            long s, e;
+            if (retryNotNull) {
+                // After an empty match std::regex retries at the same offset for a non-empty one
+                retryNotNull = false;
+                e = forward.FindEnd(text, len, pos, true);
+                if (e < 0) { pos++; continue; }
+                s = (long)pos;
+            } else {
+                e = forward.FindEnd(text, len, pos);
+                if (e < 0) break;
+                s = reverse.FindStart(text, len, (size_t)e, pos);
+                if (s < 0) s = e; // unreachable for consistent programs, keeps iteration safe
+            }
+            m.start = (size_t)s;
+            m.length = (size_t)(e - s);
+            m.groups.clear();
+            if (wantGroups && captureCount > 0) {
+                int slots = (captureCount + 1) * 2;
+                if (PikeMatch(forwardProg, sets, slots, text, len, (size_t)s, e > s, caps)) {
+                    for (int k = 1; k <= captureCount; k++) {
+                        long gs = caps[k * 2], ge = caps[k * 2 + 1];
+                        if (gs >= 0 && ge >= gs) m.groups.push_back({ gs, ge - gs });
+                        else m.groups.push_back({ -1, 0 });
+                    }
+                } else {
+                    for (int k = 1; k <= captureCount; k++) m.groups.push_back({ -1, 0 });
+                }
+            }
+            if (!fn(m)) break;
+            if (e == s) retryNotNull = true;
+            pos = (size_t)e;
+        }
+    }
+
+private:
+    std::vector<ByteSet> sets;
+    ReProg forwardProg;
+    ReProg reverseProg;
+    LazyDfa forward;
+    LazyDfa reverse;
+    int captureCount = 0;
+};
+
+// NATIVE MATCHER EXPORT: Materializes the forward (leftmost-first) and reverse DFAs of the dfa
+// backend and prints them as a self-contained C++17 header: constexpr tables over byte classes
+// plus the same FindEnd / FindStart loops, so the generated code matches exactly like 'dfa'.
+const size_t NATIVE_MAX_STATES = 4000;
+
+struct NativeTable {
+    DfaTables dfa;
+    std::vector<int> classReps; // one representative byte per class
+};
+
+void AppendNativeTable(std::string& out, const char* name, const NativeTable& t);
+
+bool GenerateNativeMatcher(const std::string& pattern, const std::string& ns, std::string& code, std::string& error);
+
+// LITERAL PREFILTER: Node values are raw regex fragments (a NODE_CUSTOM "{4}" modifies the node
+// before it), so required literals are extracted from the parsed AST of the generated pattern.
+struct LiteralInfo {
+    bool exact = false;  // node matches exactly one string: 'str'
+    std::string str;
+    std::string prefix;  // literal every match starts with
+    std::string suffix;  // literal every match ends with
+    std::string best;    // longest literal every match contains
+};
+
+const size_t LITERAL_MAX = 256;
+
+void KeepLongest(std::string& best, const std::string& candidate);
+
+LiteralInfo AnalyzeLiterals(const ReNode& n, const std::vector<ByteSet>& sets);
+
+bool ReHasEol(const ReNode& n);
+
+// SIMD SUBSTRING SEARCH: Compares the first and last needle byte at 16 (SSE2/NEON) or
+// 32 (AVX2) haystack offsets per step and only verifies offsets where both agree.
+inline int LowestBit(unsigned long long mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+    while (!(mask & 1)) { mask >>= 1; bit++; }
+    return bit;
+#endif
+}
+
+#if defined(REGEX_STUDIO_X86_SIMD)
+__attribute__((target("avx2")))
+size_t FindLiteralAvx2(const char* hay, size_t n, const char* needle, size_t m, size_t i);
+
+__attribute__((target("sse2")))
+size_t FindLiteralSse2(const char* hay, size_t n, const char* needle, size_t m, size_t i);
+#endif
+
+// Returns the offset of the first occurrence of needle in hay[from, n), or n if there is none
+size_t FindLiteral(const char* hay, size_t n, size_t from, const std::string& needle);
+
+// Skips input that cannot match: files/chunks without the required literal never reach the
+// engine, and when no match can span a newline (and there is no '$') only the lines that
+// contain the literal are handed to the engine.
+class LiteralPrefilter {
+public:
+    std::string literal;
+    bool lineMode = false;
+
+    void Build(const std::string& pattern) {
+        literal.clear();
+        lineMode = false;
+        try {
+            std::vector<ByteSet> sets;
+            ReParser parser(pattern, sets);
+            ReNode root = parser.Parse();
+            literal = AnalyzeLiterals(root, sets).best;
+            bool newlineMatchable = false;
+            for (const auto& b : sets) if (b.test('\n')) newlineMatchable = true;
+            lineMode = !literal.empty() && !newlineMatchable && !ReHasEol(root);
+        } catch (...) {} // syntax the parser does not know (std-only): no prefilter
+    }
+
+    bool Active() const { return !literal.empty(); }
+
+    // Same matches as engine.ForEach(begin, end, from, false, fn), minus the work on dead input
+    void ForEach(RegexEngine& engine, const char* begin, const char* end, size_t from,
+                 const std::function<bool(const EngineMatch&)>& fn) const {
+        size_t n = end - begin;
+        if (!Active()) { engine.ForEach(begin, end, from, false, fn); return; }
+        size_t hit = FindLiteral(begin, n, from, literal);
+        if (hit >= n) return;
+        if (!lineMode) { engine.ForEach(begin, end, from, false, fn); return; }
+
+        bool keepGoing = true;
+        while (hit < n && keepGoing) {
+            size_t lineStart = hit;
+            while (lineStart > from && begin[lineStart - 1] != '\n') lineStart--;
+            const void* nl = memchr(begin + hit, '\n', n - hit);
+            size_t lineEnd = nl ? (size_t)((const char*)nl - begin) : n;
+            engine.ForEach(begin, begin + lineEnd, lineStart, false, [&](const EngineMatch& m) {
+                keepGoing = fn(m);
+                return keepGoing;
+            });
+            hit = lineEnd < n ? FindLiteral(begin, n, lineEnd + 1, literal) : n;
+        }
+    }
+
+    size_t Count(RegexEngine& engine, const char* begin, const char* end) const {
+        if (!Active()) return engine.Count(begin, end);
+        size_t count = 0;
+        ForEach(engine, begin, end, 0, [&](const EngineMatch&) { count++; return true; });
+        return count;
+    }
+};
+
+// CHUNK WINDOW: One window of a chunked search (stream scans, the playground counter). Matches
+// starting before 'boundary' (anywhere when 'last') are final and go to fn; the search stops at
+// the first one past it. Returns where the next window searches from: max(end of the last final
+// match, boundary). Never the deferred match itself, since an earlier start may only show up
+// with the next window's bytes. MatchBudgetExceeded propagates to the caller.
+size_t SearchChunkWindow(const LiteralPrefilter& prefilter, RegexEngine& engine, const char* data, size_t size,
+                         size_t from, size_t boundary, bool last, const std::function<void(const EngineMatch&)>& fn);
+
+// LITERAL SET (Aho-Corasick): One pass over the input tells which patterns of a set can match,
+// i.e. whose required literal occurs. Transitions are a dense table over the bytes that appear
+// in the literals (all other bytes share one class), outputs are folded along suffix links.
+class LiteralSetIndex {
+public:
+    static const size_t MAX_LITERAL = 32; // any substring of a required literal is required too
+
+    // literals[p] empty = pattern p has no literal and is always a candidate
+    void Build(const std::vector<std::string>& literals) {
+        patternCount = literals.size();
+        always.assign(patternCount, 0);
+        std::fill(std::begin(byteClass), std::end(byteClass), 0);
+        classes = 1;
+        for (const auto& lit : literals) {
+            for (size_t k = 0; k < lit.size() && k < MAX_LITERAL; k++) {
+                unsigned char c = (unsigned char)lit[k];
+                if (!byteClass[c]) byteClass[c] = classes++;
+            }
+        }
+        table.assign(classes, -1);
+        fail.assign(1, 0);
+        outputs.assign(1, {});
+        for (size_t p = 0; p < literals.size(); p++) {
+            if (literals[p].empty()) { always[p] = 1; continue; }
+            int node = 0;
+            for (size_t k = 0; k < literals[p].size() && k < MAX_LITERAL; k++) {
+                int& next = table[(size_t)node * classes + byteClass[(unsigned char)literals[p][k]]];
+                if (next < 0) {
+                    next = (int)fail.size();
+                    fail.push_back(0);
+                    outputs.push_back({});
+                    table.resize(table.size() + classes, -1);
+                }
+                node = table[(size_t)node * classes + byteClass[(unsigned char)literals[p][k]]];
+            }
+            outputs[node].push_back((int)p);
+        }
+        // BFS: fill missing edges with the failure target so scanning never backtracks
+        std::deque<int> queue;
+        for (int c = 0; c < classes; c++) {
+            int& next = table[c];
+            if (next < 0) next = 0;
+            else { fail[next] = 0; queue.push_back(next); }
+        }
+        while (!queue.empty()) {
+            int node = queue.front(); queue.pop_front();
+            const std::vector<int>& inherited = outputs[fail[node]];
+            outputs[node].insert(outputs[node].end(), inherited.begin(), inherited.end());
+            for (int c = 0; c < classes; c++) {
+                int& next = table[(size_t)node * classes + c];
+                int viaFail = table[(size_t)fail[node] * classes + c];
+                if (next < 0) next = viaFail;
+                else { fail[next] = viaFail; queue.push_back(next); }
+            }
+        }
+    }
+
+    // candidates[p] = 1 if pattern p can match somewhere in [data, data + n)
+    void Scan(const char* data, size_t n, std::vector<char>& candidates) const {
+        candidates = always;
+        size_t remaining = 0;
+        for (char a : always) if (!a) remaining++;
+        const unsigned char* t = (const unsigned char*)data;
+        int node = 0;
+        for (size_t i = 0; i < n && remaining > 0; i++) {
+            node = table[(size_t)node * classes + byteClass[t[i]]];
+            for (int p : outputs[node]) {
+                if (!candidates[p]) { candidates[p] = 1; remaining--; }
+            }
+        }
+    }
+
+private:
+    size_t patternCount = 0;
+    int byteClass[256] = {};
+    int classes = 1;
+    std::vector<int> table;               // node * classes + class -> node
+    std::vector<int> fail;
+    std::vector<std::vector<int>> outputs; // patterns whose literal ends at this node
+    std::vector<char> always;
+};
+
+// PATTERN COMPLEXITY: Static check for shapes a backtracking engine can take super-linear time on.
+// Nested quantifiers and overlapping alternatives inside a loop are exponential, adjacent loops
+// over shared characters are polynomial. A heuristic over the lenient AST, not a proof.
+enum RiskLevel { RISK_NONE, RISK_POLYNOMIAL, RISK_EXPONENTIAL };
+
+struct RiskFinding {
+    RiskLevel level;
+    int degree;      // RISK_POLYNOMIAL: O(n^degree) per match attempt
+    size_t from, to; // offending range of the pattern
+    std::string reason;
+};
+
+struct PatternRisk {
+    bool analyzed = false; // false when even the lenient parser rejected the pattern
+    RiskLevel level = RISK_NONE;
+    int degree = 1;
+    std::vector<RiskFinding> findings;
+
+    std::string Complexity() const {
+        if (level == RISK_EXPONENTIAL) return "O(2^n)";
+        return degree > 1 ? "O(n^" + std::to_string(degree) + ")" : "O(n)";
+    }
+};
+
+const int RISK_LOOP_MIN = 16; // bounded repeats from this count up backtrack like unbounded ones
+
+class ComplexityAnalyzer {
+public:
+    PatternRisk Run(const std::string& pattern) {
+        PatternRisk risk;
+        try {
+            ReParser parser(pattern, sets, true);
+            Visit(parser.Parse(), 0);
+        } catch (...) { return risk; }
+        risk.analyzed = true;
+        for (const auto& f : findings) {
+            risk.level = std::max(risk.level, f.level);
+            if (f.level == RISK_POLYNOMIAL) risk.degree = std::max(risk.degree, f.degree);
+        }
+        risk.findings = std::move(findings);
+        return risk;
+    }
+
+private:
+    struct Shape {
+        bool nullable = true;
+        bool unbounded = false; // can consume arbitrarily long input
+        bool loop = false;      // can match through one variable repeat alone (everything else empty)
+        ByteSet first;          // bytes a non-empty match can start with
+        ByteSet chars;          // bytes a match can contain
+    };
+    std::vector<ByteSet> sets;
+    std::vector<RiskFinding> findings;
+
+    static bool IsLoop(const ReNode& n) { return n.max < 0 || n.max >= RISK_LOOP_MIN; }
+
+    // Fixed-width branch as one byte set per position; false if it has variable parts
+    bool Flatten(const ReNode& n, std::vector<ByteSet>& out) const {
+        switch (n.type) {
+            case RE_EMPTY: case RE_BOL: case RE_EOL: return true;
+            case RE_SET: out.push_back(sets[n.set]); return true;
+            case RE_GROUP: return Flatten(n.kids[0], out);
+            case RE_CAT:
+                for (const auto& k : n.kids) if (!Flatten(k, out)) return false;
+                return true;
+            case RE_REPEAT:
+                if (n.min != n.max || n.min > RISK_LOOP_MIN) return false;
+                for (int k = 0; k < n.min; k++) if (!Flatten(n.kids[0], out)) return false;
+                return true;
+            case RE_ALT: return false;
+        }
+        return false;
+    }
+
+    // Can both alternatives match the same text (or one a prefix the next iteration continues)?
+    bool BranchesOverlap(const ReNode& a, const ReNode& b, const Shape& sa, const Shape& sb, const ByteSet& altFirst) const {
+        if ((sa.first & sb.first).none()) return false;
+        std::vector<ByteSet> fa, fb;
+        if (!Flatten(a, fa) || !Flatten(b, fb)) return true;
+        size_t common = std::min(fa.size(), fb.size());
+        for (size_t k = 0; k < common; k++) if ((fa[k] & fb[k]).none()) return false;
+        if (fa.size() == fb.size()) return true;
+        const ByteSet& rest = fa.size() > common ? fa[common] : fb[common];
+        return (rest & altFirst).any();
+    }
+
+    void Report(RiskLevel level, int degree, size_t from, size_t to, const std::string& reason) {
+        findings.push_back({ level, degree, from, to, reason });
+    }
+
+    Shape Visit(const ReNode& n, int loopDepth) {
+        Shape sh;
+        switch (n.type) {
+            case RE_EMPTY: case RE_BOL: case RE_EOL:
+                break;
+            case RE_SET:
+                sh.nullable = false;
+                sh.first = sh.chars = sets[n.set];
+                break;
+            case RE_GROUP:
+                return Visit(n.kids[0], loopDepth);
+            case RE_ALT: {
+                std::vector<Shape> kids;
+                sh.nullable = false;
+                for (const auto& k : n.kids) {
+                    kids.push_back(Visit(k, loopDepth));
+                    const Shape& ks = kids.back();
+                    sh.nullable |= ks.nullable;
+                    sh.unbounded |= ks.unbounded;
+                    sh.loop |= ks.loop;
+                    sh.first |= ks.first;
+                    sh.chars |= ks.chars;
+                }
+                if (loopDepth == 0) break;
+                for (size_t i = 0; i < n.kids.size(); i++) {
+                    for (size_t j = i + 1; j < n.kids.size(); j++) {
+                        if (!BranchesOverlap(n.kids[i], n.kids[j], kids[i], kids[j], sh.first)) continue;
+                        Report(RISK_EXPONENTIAL, 0, n.from, n.to, "alternatives " + std::to_string(i + 1) + " and " + std::to_string(j + 1) + " can match the same text inside a loop");
+                        return sh;
+                    }
+                }
+                break;
+            }
+            case RE_REPEAT: {
+                bool loop = IsLoop(n);
+                Shape kid = Visit(n.kids[0], loopDepth + (loop ? 1 : 0));
+                sh = kid;
+                sh.nullable = n.min == 0 || kid.nullable;
+                sh.unbounded = kid.unbounded || (loop && kid.chars.any());
+                bool variable = (n.max < 0 || n.max > n.min) && n.max != 1 && kid.chars.any();
+                sh.loop = kid.loop || variable;
+                if (loop && kid.loop) Report(RISK_EXPONENTIAL, 0, n.from, n.to, "nested quantifier: iterations can split the same text in many ways");
+                break;
+            }
+            case RE_CAT: {
+                std::vector<Shape> kids;
+                bool prefixNullable = true;
+                for (const auto& k : n.kids) {
+                    kids.push_back(Visit(k, loopDepth));
+                    const Shape& ks = kids.back();
+                    if (prefixNullable) sh.first |= ks.first;
+                    prefixNullable &= ks.nullable;
+                    sh.unbounded |= ks.unbounded;
+                    sh.chars |= ks.chars;
+                }
+                sh.nullable = prefixNullable;
+                // One loop with only optional neighbours (if anything is required, it is the loop)
+                size_t solid = 0;
+                for (const auto& ks : kids) if (!ks.nullable) solid++;
+                for (const auto& ks : kids) if (ks.loop && (solid == 0 || (solid == 1 && !ks.nullable))) sh.loop = true;
+
+                // Chains of unbounded kids over shared bytes with only optional kids in between:
+                // each extra link lets the split point move, O(n^length) per match attempt
+                std::vector<int> degree(kids.size(), 0), chainStart(kids.size(), 0);
+                std::vector<bool> extended(kids.size(), false);
+                for (size_t j = 0; j < kids.size(); j++) {
+                    if (!kids[j].unbounded) continue;
+                    degree[j] = 1; chainStart[j] = (int)j;
+                    int best = -1;
+                    for (size_t i = j; i-- > 0;) {
+                        if (kids[i].unbounded && (kids[i].chars & kids[j].chars).any() && (best < 0 || degree[i] > degree[best])) best = (int)i;
+                        if (!kids[i].nullable) break;
+                    }
+                    if (best >= 0) {
+                        degree[j] = degree[best] + 1;
+                        chainStart[j] = chainStart[best];
+                        extended[best] = true;
+                    }
+                }
+                for (size_t j = 0; j < kids.size(); j++) {
+                    if (degree[j] < 2 || extended[j]) continue;
+                    Report(RISK_POLYNOMIAL, degree[j], n.kids[chainStart[j]].from, n.kids[j].to,
+                           std::to_string(degree[j]) + " adjacent loops can match the same characters");
+                }
+                break;
+            }
+        }
+        return sh;
+    }
+};
+
+PatternRisk AnalyzePatternComplexity(const std::string& pattern);
+
+// EMPTY LOOPS: ECMAScript rejects a loop iteration that matches nothing once the minimum count
+// is reached; the dfa backend does not, so '(b?)*' or '(\w*)+' capture (and sometimes end)
+// differently from std. 'auto' sends patterns with such a loop to std.
+bool ReNullable(const ReNode& n);
+bool ReHasEmptyLoop(const ReNode& n);
+bool DfaMatchesStdSemantics(const std::string& pattern);
+
+// Creates and compiles the requested backend. Returns nullptr (and fills error) on failure.
+std::unique_ptr<RegexEngine> CompileEngine(EngineType type, const std::string& pattern, std::string& error);
+
+const char* EngineTypeName(EngineType type);
+
+// BYTE ENCODING: Little-endian helpers shared by project files and the scan cache
+uint32_t Fnv1a(const char* data, size_t size);
+
+void PutU32(std::string& out, uint32_t v);
+
+void PutF32(std::string& out, float f);
+
+uint32_t GetU32(const char* p);
+
+float GetF32(const char* p);
+
+uint64_t Fnv1a64(const char* data, size_t size, uint64_t h = 14695981039346656037ull);
+
+void PutU64(std::string& out, uint64_t v);
+
+uint64_t GetU64(const char* p);
+
+// ----------------------------------------------------------------------------------
+// File Scanner
+// ----------------------------------------------------------------------------------
+
+struct ScanLocation {
+    uint64_t line;
+    uint64_t column;
+    std::string text; // matched text, clipped for display
+};
+
+struct ScanHit {
+    std::string path;
+    size_t count = 0;
+    std::vector<ScanLocation> locations; // --lines only: the first maxLocations matches
+    std::string warning;                  // set when the match budget aborted this file
+    int pattern = 0;                      // index into the scanned pattern set, -1 for a file-level warning
+};
+
+// NEWLINE COUNT: 32/16 bytes per step with compare + popcount
+#if defined(REGEX_STUDIO_X86_SIMD)
+__attribute__((target("avx2,popcnt")))
+size_t CountNewlinesAvx2(const char* p, size_t n, size_t& i);
+
+__attribute__((target("sse2")))
+size_t CountNewlinesSse2(const char* p, size_t n, size_t& i);
+#endif
+
+size_t CountNewlines(const char* p, size_t n);
+
+// Lazily maps byte offsets to line/column. Only advanced up to the matches that get reported,
+// so a counting scan never pays for it. Offsets passed to Advance must not decrease.
+struct LineLocator {
+    uint64_t line = 1;      // line number at 'offset'
+    uint64_t lineStart = 0; // absolute offset where that line begins
+    uint64_t offset = 0;    // absolute offset counted up to
+
+    // data holds the bytes starting at absolute offset dataBase and covers [offset, target)
+    void Advance(const char* data, uint64_t dataBase, uint64_t target) {
+        if (target <= offset) return;
+        const char* from = data + (offset - dataBase);
+        size_t len = (size_t)(target - offset);
+        size_t lines = CountNewlines(from, len);
+        if (lines > 0) {
+            line += lines;
+            size_t k = len;
+            while (k > 0 && from[k - 1] != '\n') k--;
+            lineStart = offset + k;
+        }
+        offset = target;
+    }
+};
+
+struct ScanOptions {
+    std::string pattern;
+    EngineType engine = ENGINE_AUTO;
+    unsigned threads = 0;              // 0 = hardware concurrency
+    bool stream = false;               // chunked reads instead of whole-file views
+    size_t chunkSize = 4 * 1024 * 1024; // stream buffer per worker (bounds peak memory)
+    size_t overlap = 64 * 1024;        // bytes carried between chunks = longest match found exactly
+    bool lines = false;                // report file:line:col for the first matches of each file
+    size_t maxLocations = 10;
+    std::vector<std::string> patterns;     // pattern set: every file is read once for all of them (empty = 'pattern')
+    std::vector<std::string> patternNames; // labels for per-pattern counts
+    std::vector<std::string> include;      // globs; when set, only matching files are scanned
+    std::vector<std::string> exclude;      // globs; matching directories are pruned, not listed
+    uintmax_t maxFileSize = 0;             // 0 = no limit
+    bool skipBinary = true;                // NUL byte in the first BINARY_SNIFF bytes = binary
+    bool skipVcs = true;                   // prune .git / .hg / .svn
+    bool gitignore = false;                // honour .gitignore files under the scan root
+    std::string cachePath;                 // persistent result cache; empty = off
+};
+
+const size_t BINARY_SNIFF = 8192;
+
+// GLOB: '*' and '?' stay inside one path segment, '**' crosses '/', "[a-z]" / "[!x]" are classes
+bool GlobMatch(const char* p, const char* s);
+
+// One include/exclude glob or .gitignore line, matched against the '/' separated path
+// relative to the scan root. A glob without '/' matches at any depth, as in .gitignore.
+struct GlobRule {
+    std::string glob;
+    std::string base;     // directory of the .gitignore that declared it ("" or "sub/dir/")
+    bool negate = false;  // "!pattern" re-includes
+    bool dirOnly = false; // "pattern/" only matches directories
+};
+
+bool MakeGlobRule(std::string line, const std::string& base, GlobRule& rule);
+
+bool GlobRuleMatches(const GlobRule& rule, const std::string& rel, bool isDir);
+
+// Last matching rule wins: 1 = excluded, 0 = re-included by a negation, -1 = no rule matched
+int LastGlobMatch(const std::vector<GlobRule>& rules, const std::string& rel, bool isDir);
+
+// SCAN FILTER: Runs on the producer thread and decides from the directory entry alone whether a
+// path is worth opening. Excluded directories are pruned before their contents are listed.
+// .gitignore rules are stacked per directory depth and dropped when the walk leaves it.
+class ScanFilter {
+public:
+    void Configure(const ScanOptions& opts, const std::filesystem::path& root) {
+        GlobRule rule;
+        include.clear();
+        exclude.clear();
+        ignoreRules.clear();
+        frames.clear();
+        for (const auto& g : opts.include) if (MakeGlobRule(g, "", rule)) include.push_back(rule);
+        for (const auto& g : opts.exclude) if (MakeGlobRule(g, "", rule)) exclude.push_back(rule);
+        maxFileSize = opts.maxFileSize;
+        skipVcs = opts.skipVcs;
+        gitignore = opts.gitignore;
+        if (gitignore) LoadIgnoreFile(root / ".gitignore", "", -1);
+    }
+
+    bool ExcludeDirectory(const std::string& rel, const std::string& name, int depth) {
+        Unwind(depth);
+        if (skipVcs && (name == ".git" || name == ".hg" || name == ".svn")) return true;
+        if (LastGlobMatch(exclude, rel, true) == 1) return true;
+        return LastGlobMatch(ignoreRules, rel, true) == 1;
+    }
+
+    bool ExcludeFile(const std::string& rel, uintmax_t size, int depth) {
+        Unwind(depth);
+        if (maxFileSize && size > maxFileSize) return true;
+        if (!include.empty() && LastGlobMatch(include, rel, false) != 1) return true;
+        if (LastGlobMatch(exclude, rel, false) == 1) return true;
+        return LastGlobMatch(ignoreRules, rel, false) == 1;
+    }
+
+    // Called for every directory the walk descends into
+    void EnterDirectory(const std::filesystem::path& dir, const std::string& rel, int depth) {
+        if (gitignore) LoadIgnoreFile(dir / ".gitignore", rel + "/", depth);
+    }
+
+private:
+    struct Frame { int depth; size_t firstRule; };
+    std::vector<GlobRule> include, exclude, ignoreRules;
+    std::vector<Frame> frames;
+    uintmax_t maxFileSize = 0;
+    bool skipVcs = true;
+    bool gitignore = false;
+
+    void LoadIgnoreFile(const std::filesystem::path& file, const std::string& base, int depth) {
+        std::ifstream in(file);
+        if (!in.is_open()) return;
+        frames.push_back({ depth, ignoreRules.size() });
+        std::string line;
+        GlobRule rule;
+        while (std::getline(in, line)) if (MakeGlobRule(line, base, rule)) ignoreRules.push_back(rule);
+    }
+
+    // Entries at 'depth' are outside every directory entered at the same or a deeper level
+    void Unwind(int depth) {
+        while (!frames.empty() && frames.back().depth >= depth) {
+            ignoreRules.resize(frames.back().firstRule);
+            frames.pop_back();
+        }
+    }
+};
+
+bool LooksBinary(const char* data, size_t size);
+
+// Parses "512", "64k", "10m" or "2g"; false on anything else
+bool ParseByteSize(const std::string& text, uintmax_t& out);
+
+// Appends the comma separated globs of one --include / --exclude argument
+void AddGlobs(std::vector<std::string>& globs, const std::string& list);
+
+struct QueuedFile {
+    std::filesystem::path path;
+    uintmax_t size = 0; // as walked: what the file added to bytesQueued
+};
+
+// WORK-STEALING QUEUE: The owner pops from the back (LIFO, cache warm), thieves take from the front
+class WorkStealingQueue {
+public:
+    void Push(QueuedFile p) {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(p));
+    }
+    bool Pop(QueuedFile& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        out = std::move(items.back());
+        items.pop_back();
+        return true;
+    }
+    bool Steal(QueuedFile& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<QueuedFile> items;
+};
+
+// FILE VIEW: Read-only bytes of a file. Large files are memory-mapped and matched in place,
+// small ones take a single pre-sized read into a buffer the worker reuses between files.
+class FileView {
+public:
+    static const size_t MAP_THRESHOLD = 64 * 1024;
+
+    ~FileView() { Close(); }
+
+    bool Open(const std::filesystem::path& path, std::vector<char>& smallBuffer) {
+        Close();
+        std::error_code ec;
+        uintmax_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        if (fileSize == 0) { data = ""; size = 0; return true; }
+        if (fileSize >= MAP_THRESHOLD && Map(path, fileSize)) return true;
+
+        // Small file (or mapping failed): one read straight into the reusable buffer
+        if (fileSize > (uintmax_t)SIZE_MAX) return false;
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        smallBuffer.resize((size_t)fileSize);
+        file.read(smallBuffer.data(), (std::streamsize)fileSize);
+        size = (size_t)file.gcount();
+        data = smallBuffer.data();
+        return true;
+    }
+
+    void Close() {
+#if defined(_WIN32)
+        if (mapped) UnmapViewOfFile(mapped);
+        if (mapping) CloseHandle(mapping);
+        if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+        mapping = NULL;
+        handle = INVALID_HANDLE_VALUE;
+#else
+        if (mapped) munmap(mapped, size);
+#endif
+        mapped = nullptr;
+        data = nullptr;
+        size = 0;
+    }
+
+    const char* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    void* mapped = nullptr;
+#if defined(_WIN32)
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+
+    bool Map(const std::filesystem::path& path, uintmax_t fileSize) {
+        if (fileSize > (uintmax_t)SIZE_MAX) return false;
+#if defined(_WIN32)
+        handle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (handle == INVALID_HANDLE_VALUE) return false;
+        mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) { Close(); return false; }
+        mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!mapped) { Close(); return false; }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        void* p = mmap(nullptr, (size_t)fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        madvise(p, (size_t)fileSize, MADV_SEQUENTIAL);
+        mapped = p;
+#endif
+        data = (const char*)mapped;
+        size = (size_t)fileSize;
+        return true;
+    }
+};
+
+// COMPRESSED INPUT: Archives are recognised by their magic bytes, not the extension,
+// so rotated "app.log.1.gz" and extension-less dumps are handled alike.
+enum CompressionType { COMPRESSION_NONE, COMPRESSION_GZIP, COMPRESSION_ZSTD };
+
+CompressionType DetectCompression(const char* data, size_t size);
+
+bool CompressionSupported(CompressionType type);
+
+// Sequential bytes of a file for the stream scanner. Read() returns 0 at the end (or on
+// error, with 'error' set); Consumed() is the number of bytes taken from disk so far.
+class ByteReader {
+public:
+    std::string error;
+    virtual ~ByteReader() {}
+    virtual size_t Read(char* dst, size_t n) = 0;
+    virtual uint64_t Consumed() const = 0;
+    virtual bool Seek(uint64_t) { return false; } // only plain files can start mid-way
+
+    // Loops until 'n' bytes are read or the input ends
+    size_t ReadFull(char* dst, size_t n) {
+        size_t got = 0;
+        while (got < n) {
+            size_t k = Read(dst + got, n - got);
+            if (k == 0) break;
+            got += k;
+        }
+        return got;
+    }
+};
+
+// Opens 'path' for sequential reading, decompressing it when the build supports the format
+std::unique_ptr<ByteReader> OpenByteReader(const std::filesystem::path& path, CompressionType& type);
+
+// RESULT QUEUE: Workers post hits here, the render thread drains it once per frame
+class ScanResultQueue {
+public:
+    void Push(ScanHit hit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(hit));
+    }
+    size_t Drain(std::vector<ScanHit>& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = items.size();
+        for (auto& h : items) out.push_back(std::move(h));
+        items.clear();
+        return n;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<ScanHit> items;
+};
+
+// FILE IDENTITY: What the scan cache compares to decide that a file is unchanged or only grew
+struct FileIdentity {
+    uint64_t size = 0;
+    uint64_t mtime = 0; // nanoseconds (POSIX) or file-time ticks (Windows)
+    uint64_t inode = 0; // 0 where the platform has none; appends are then never assumed
+};
+
+bool StatFileIdentity(const std::filesystem::path& path, FileIdentity& id);
+
+// Where an append-only re-scan picks a pattern up: matches starting before 'resume' are final,
+// everything from there on is matched again (a match at EOF may still grow).
+struct ScanCheckpoint {
+    uint64_t count = 0;          // matches in the whole file at the time of the scan
+    uint64_t heldCount = 0;      // matches that start before 'resume'
+    uint64_t resume = 0;
+    uint64_t line = 0;           // line locator at 'resume' (line mode; 0 = not tracked)
+    uint64_t lineStart = 0;
+    uint32_t heldLocations = 0;  // locations that belong to heldCount
+    std::vector<ScanLocation> locations;
+};
+
+struct ScanCacheEntry {
+    FileIdentity id;
+    bool compressed = false;  // archives are only reused when unchanged, never resumed
+    uint64_t tailFrom = 0;    // FNV-1a of [tailFrom, earliest resume): proves the old bytes are intact
+    uint32_t tailHash = 0;
+    bool seen = false;        // touched by the current scan (not persisted)
+    std::vector<ScanCheckpoint> patterns;
+};
+
+// SCAN CACHE: (absolute path, pattern-set hash) -> checkpoints, persisted between runs.
+//   "VRSCAN_1" | u32 entries | u32 checksum (FNV-1a of the records)
+//   entry: u32 key len | key | u64 size | u64 mtime | u64 inode | u8 compressed | u64 tailFrom | u32 tailHash | u32 patterns
+//   pattern: u64 count | u64 held | u64 resume | u64 line | u64 lineStart | u32 heldLocations | u32 locations
+//   location: u64 line | u64 column | u32 text len | text
+class ScanCache {
+public:
+    static const size_t TAIL_BYTES = 4096;
+
+    static std::string SetSuffix(uint64_t setHash) {
+        char hex[20];
+        snprintf(hex, sizeof(hex), "|%016llx", (unsigned long long)setHash);
+        return hex;
+    }
+
+    static std::string Key(const std::filesystem::path& path, uint64_t setHash) {
+        return std::filesystem::absolute(path).lexically_normal().generic_string() + SetSuffix(setHash);
+    }
+
+    bool Lookup(const std::string& key, ScanCacheEntry& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) return false;
+        it->second.seen = true;
+        out = it->second;
+        return true;
+    }
+
+    void Store(const std::string& key, ScanCacheEntry entry) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry.seen = true;
+        entries[key] = std::move(entry);
+    }
+
+    // Entries of this pattern set under 'scope' that the last scan did not reach were deleted or filtered out
+    void DropUnseen(const std::string& scope, uint64_t setHash) {
+        std::string suffix = SetSuffix(setHash);
+        for (auto it = entries.begin(); it != entries.end();) {
+            const std::string& k = it->first;
+            bool sameSet = k.size() >= suffix.size() && k.compare(k.size() - suffix.size(), suffix.size(), suffix) == 0;
+            if (!it->second.seen && sameSet && k.compare(0, scope.size(), scope) == 0) it = entries.erase(it);
+            else ++it;
+        }
+    }
+
+    size_t Size() const { return entries.size(); }
+
+    // A missing file is an empty cache; a damaged one is reported and ignored
+    bool Load(const std::string& path, std::string& error) {
+        entries.clear();
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return true;
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.size() < 16 || memcmp(data.data(), "VRSCAN_1", 8) != 0) { error = "not a scan cache: " + path; return false; }
+        uint32_t count = GetU32(data.data() + 8);
+        if (Fnv1a(data.data() + 16, data.size() - 16) != GetU32(data.data() + 12)) { error = "scan cache checksum mismatch: " + path; return false; }
+        const char* p = data.data() + 16;
+        const char* end = data.data() + data.size();
+        auto need = [&](size_t n) { return (size_t)(end - p) >= n; };
+        for (uint32_t e = 0; e < count; e++) {
+            if (!need(4)) break;
+            uint32_t keyLen = GetU32(p); p += 4;
+            if (!need((size_t)keyLen + 41)) break;
+            std::string key(p, keyLen); p += keyLen;
+            ScanCacheEntry entry;
+            entry.id.size = GetU64(p); entry.id.mtime = GetU64(p + 8); entry.id.inode = GetU64(p + 16);
+            entry.compressed = p[24] != 0;
+            entry.tailFrom = GetU64(p + 25); entry.tailHash = GetU32(p + 33);
+            uint32_t patternCount = GetU32(p + 37); p += 41;
+            bool ok = true;
+            for (uint32_t k = 0; k < patternCount && ok; k++) {
+                if (!need(48)) { ok = false; break; }
+                ScanCheckpoint cp;
+                cp.count = GetU64(p); cp.heldCount = GetU64(p + 8); cp.resume = GetU64(p + 16);
+                cp.line = GetU64(p + 24); cp.lineStart = GetU64(p + 32);
+                cp.heldLocations = GetU32(p + 40);
+                uint32_t locCount = GetU32(p + 44); p += 48;
+                for (uint32_t l = 0; l < locCount; l++) {
+                    if (!need(20)) { ok = false; break; }
+                    ScanLocation loc;
+                    loc.line = GetU64(p); loc.column = GetU64(p + 8);
+                    uint32_t len = GetU32(p + 16); p += 20;
+                    if (!need(len)) { ok = false; break; }
+                    loc.text.assign(p, len); p += len;
+                    cp.locations.push_back(loc);
+                }
+                entry.patterns.push_back(std::move(cp));
+            }
+            if (!ok) break;
+            entries[key] = std::move(entry);
+        }
+        if (entries.size() != count) { error = "scan cache truncated: " + path; entries.clear(); return false; }
+        return true;
+    }
+
+    bool Save(const std::string& path, std::string& error) const {
+        std::string records;
+        for (const auto& kv : entries) {
+            const ScanCacheEntry& e = kv.second;
+            PutU32(records, (uint32_t)kv.first.size());
+            records += kv.first;
+            PutU64(records, e.id.size); PutU64(records, e.id.mtime); PutU64(records, e.id.inode);
+            records += (char)(e.compressed ? 1 : 0);
+            PutU64(records, e.tailFrom); PutU32(records, e.tailHash);
+            PutU32(records, (uint32_t)e.patterns.size());
+            for (const auto& cp : e.patterns) {
+                PutU64(records, cp.count); PutU64(records, cp.heldCount); PutU64(records, cp.resume);
+                PutU64(records, cp.line); PutU64(records, cp.lineStart);
+                PutU32(records, cp.heldLocations); PutU32(records, (uint32_t)cp.locations.size());
+                for (const auto& loc : cp.locations) {
+                    PutU64(records, loc.line); PutU64(records, loc.column);
+                    PutU32(records, (uint32_t)loc.text.size());
+                    records += loc.text;
+                }
+            }
+        }
+        std::string header("VRSCAN_1", 8);
+        PutU32(header, (uint32_t)entries.size());
+        PutU32(header, Fnv1a(records.data(), records.size()));
+        // Write next to the target and rename, so an interrupted save never leaves a torn cache
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) { error = "cannot write " + temp; return false; }
+            out.write(header.data(), (std::streamsize)header.size());
+            out.write(records.data(), (std::streamsize)records.size());
+            if (!out) { error = "write failed: " + temp; return false; }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) { error = "cannot replace " + path + ": " + ec.message(); return false; }
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, ScanCacheEntry> entries;
+};
+
+// FNV-1a of [from, from + len) of a file; false when it cannot be read completely
+bool HashFileRange(const std::filesystem::path& path, uint64_t from, size_t len, uint32_t& hash);
+
+// Background scan job: a producer thread walks the target recursively and a worker pool
+// matches files. Every worker compiles its own engine; totals are plain atomics so the UI
+// can read progress at any time, hits stream out through 'results'.
+class FileScanner {
+public:
+    std::atomic<uint64_t> filesQueued{ 0 };
+    std::atomic<uint64_t> bytesQueued{ 0 };
+    std::atomic<uint64_t> filesScanned{ 0 };
+    std::atomic<uint64_t> bytesScanned{ 0 };
+    std::atomic<uint64_t> totalMatches{ 0 };
+    std::atomic<uint64_t> filesAborted{ 0 };
+    std::atomic<uint64_t> filesFiltered{ 0 }; // rejected by globs / size / .gitignore, never opened
+    std::atomic<uint64_t> dirsPruned{ 0 };
+    std::atomic<uint64_t> filesBinary{ 0 };   // opened, sniffed and skipped
+    std::atomic<uint64_t> filesUnreadable{ 0 }; // queued but could not be opened or read
+    std::atomic<uint64_t> archivesScanned{ 0 };
+    std::atomic<uint64_t> bytesInflated{ 0 };   // decompressed bytes matched from archives
+    std::atomic<uint64_t> filesCached{ 0 };     // unchanged since the cached scan, not opened
+    std::atomic<uint64_t> filesResumed{ 0 };    // grew since the cached scan, matched from the checkpoint
+    std::atomic<uint64_t> bytesReused{ 0 };
+    std::string cacheStatus;                    // load/save problems, read once 'finished' is set
+    std::unique_ptr<std::atomic<uint64_t>[]> workerBusyUs; // per worker, time spent on files (not waiting)
+    unsigned workerCount = 0;
+    std::atomic<bool> producerDone{ false };
+    std::atomic<bool> finished{ false };
+    ScanResultQueue results;
+    std::vector<LiteralPrefilter> prefilters; // one per pattern, shared read-only by all workers
+    std::unique_ptr<std::atomic<uint64_t>[]> patternMatches; // per-pattern totals
+
+    ~FileScanner() { Cancel(); Wait(); }
+
+    // Compiles the pattern for every worker and starts the job. Returns false on compile errors.
+    bool Start(const std::filesystem::path& scanRoot, const ScanOptions& opts, std::string& error) {
+        unsigned workerCount = opts.threads ? opts.threads : std::thread::hardware_concurrency();
+        if (workerCount == 0) workerCount = 4;
+
+        options = opts;
+        this->workerCount = workerCount;
+        workerBusyUs.reset(new std::atomic<uint64_t>[workerCount]);
+        for (unsigned i = 0; i < workerCount; i++) workerBusyUs[i] = 0;
+        if (options.patterns.empty()) options.patterns.push_back(options.pattern);
+        if (options.overlap >= options.chunkSize / 2) options.overlap = options.chunkSize / 2;
+        size_t patternCount = options.patterns.size();
+
+        // Compile up front so pattern errors are reported before any thread starts
+        engines.clear();
+        for (unsigned i = 0; i < workerCount; i++) {
+            engines.emplace_back();
+            for (size_t p = 0; p < patternCount; p++) {
+                engines.back().push_back(CompileEngine(options.engine, options.patterns[p], error));
+                if (!engines.back().back()) {
+                    if (patternCount > 1) error = PatternName(p) + ": " + error;
+                    return false;
+                }
+            }
+        }
+        prefilters.assign(patternCount, LiteralPrefilter());
+        std::vector<std::string> literals;
+        for (size_t p = 0; p < patternCount; p++) {
+            prefilters[p].Build(options.patterns[p]);
+            literals.push_back(prefilters[p].Active() ? prefilters[p].literal : "");
+        }
+        if (patternCount > 1) literalSet.Build(literals);
+        patternMatches.reset(new std::atomic<uint64_t>[patternCount]);
+        for (size_t p = 0; p < patternCount; p++) patternMatches[p] = 0;
+        queues.clear();
+        for (unsigned i = 0; i < workerCount; i++) queues.emplace_back(new WorkStealingQueue());
+        root = scanRoot;
+        useCache = !options.cachePath.empty();
+        if (useCache) {
+            std::string key = std::string(EngineTypeName(options.engine)) + (options.lines ? "|lines " + std::to_string(options.maxLocations) : "") +
+                              "|" + std::to_string(options.overlap) + "|";
+            for (const auto& pattern : options.patterns) key += pattern + '\0';
+            setHash = Fnv1a64(key.data(), key.size());
+            std::string loadError;
+            if (!cache.Load(options.cachePath, loadError)) cacheStatus = loadError + " (starting empty)";
+        }
+        startTime = std::chrono::steady_clock::now();
+
+        coordinator = std::thread([this, workerCount]() {
+            std::thread producer([this]() { Produce(); });
+            std::vector<std::thread> workers;
+            for (unsigned i = 0; i < workerCount; i++) workers.emplace_back([this, i]() { Work(i); });
+            producer.join();
+            for (auto& w : workers) w.join();
+            if (useCache) SaveCache();
+            finished = true;
+        });
+        return true;
+    }
+
+    void Cancel() { cancelRequested = true; NotifyWorkers(true); }
+    bool Cancelled() const { return cancelRequested; }
+    void Wait() { if (coordinator.joinable()) coordinator.join(); }
+
+    double ElapsedSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    size_t PatternCount() const { return options.patterns.size(); }
+    std::string PatternName(size_t p) const {
+        return p < options.patternNames.size() ? options.patternNames[p] : "#" + std::to_string(p + 1);
+    }
+
+private:
+    typedef std::vector<std::unique_ptr<RegexEngine>> EngineRow; // one engine per pattern
+    std::filesystem::path root;
+    ScanOptions options;
+    std::vector<EngineRow> engines; // per worker
+    LiteralSetIndex literalSet;     // pattern sets only: which patterns can match a file / chunk
+    ScanFilter filter;              // producer thread only
+    ScanCache cache;
+    bool useCache = false;
+    uint64_t setHash = 0;           // cache key part: patterns plus every option that changes the results
+    std::vector<std::unique_ptr<WorkStealingQueue>> queues;
+    std::mutex wakeMutex;           // idle workers sleep on 'wake' until wakeSeq moves
+    std::condition_variable wake;
+    uint64_t wakeSeq = 0;
+    std::atomic<bool> cancelRequested{ false };
+    std::chrono::steady_clock::time_point startTime;
+    std::thread coordinator;
+
+    // A file was queued (one worker), or the walk ended / the scan was cancelled (all of them)
+    void NotifyWorkers(bool all) {
+        { std::lock_guard<std::mutex> lock(wakeMutex); wakeSeq++; }
+        if (all) wake.notify_all(); else wake.notify_one();
+    }
+
+    void SaveCache() {
+        // A cancelled walk did not reach every file, so only a complete one may forget entries
+        if (!cancelRequested) {
+            std::error_code ec;
+            std::string scope = std::filesystem::absolute(root, ec).lexically_normal().generic_string();
+            if (!std::filesystem::is_directory(root, ec)) scope += '|';
+            else if (scope.empty() || scope.back() != '/') scope += '/';
+            cache.DropUnseen(scope, setHash);
+        }
+        std::string saveError;
+        if (!cache.Save(options.cachePath, saveError)) cacheStatus += (cacheStatus.empty() ? "" : "; ") + saveError;
+    }
+
+    void Produce() {
+        std::error_code ec;
+        size_t next = 0;
+        auto enqueue = [&](const std::filesystem::path& p, uintmax_t size) {
+            queues[next++ % queues.size()]->Push({ p, size });
+            bytesQueued += size;
+            filesQueued++;
+            NotifyWorkers(false);
+        };
+        if (std::filesystem::is_directory(root, ec)) {
+            filter.Configure(options, root);
+            auto opts = std::filesystem::directory_options::skip_permission_denied;
+            std::filesystem::recursive_directory_iterator it(root, opts, ec), end;
+            for (; !ec && it != end && !cancelRequested; it.increment(ec)) {
+                std::error_code typeEc;
+                std::string rel = it->path().lexically_relative(root).generic_string();
+                if (it->is_directory(typeEc)) {
+                    if (filter.ExcludeDirectory(rel, it->path().filename().string(), it.depth())) {
+                        it.disable_recursion_pending();
+                        dirsPruned++;
+                    } else filter.EnterDirectory(it->path(), rel, it.depth());
+                    continue;
+                }
+                if (!it->is_regular_file(typeEc)) continue;
+                uintmax_t size = it->file_size(typeEc);
+                if (typeEc) size = 0;
+                if (filter.ExcludeFile(rel, size, it.depth())) { filesFiltered++; continue; }
+                enqueue(it->path(), size);
+            }
+        } else if (std::filesystem::is_regular_file(root, ec)) {
+            std::error_code sizeEc;
+            uintmax_t size = std::filesystem::file_size(root, sizeEc);
+            enqueue(root, sizeEc ? 0 : size);
+        }
+        producerDone = true;
+        NotifyWorkers(true);
+    }
+
+    bool NextFile(unsigned self, QueuedFile& out) {
+        while (!cancelRequested) {
+            uint64_t seen;
+            { std::lock_guard<std::mutex> lock(wakeMutex); seen = wakeSeq; }
+            if (queues[self]->Pop(out)) return true;
+            for (size_t k = 1; k < queues.size(); k++) {
+                if (queues[(self + k) % queues.size()]->Steal(out)) return true;
+            }
+            if (producerDone) {
+                // Re-check once: the producer may have pushed between our scan and the flag
+                for (size_t k = 0; k < queues.size(); k++) if (queues[(self + k) % queues.size()]->Steal(out)) return true;
+                return false;
+            }
+            // Nothing to pop or steal while the producer is still walking: sleep until it queues more
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&] { return wakeSeq != seen; });
+        }
+        return false;
+    }
+
+    // LINE MODE: Resolves line/column for the match and keeps its text (first matches only)
+    void RecordLocation(ScanHit& hit, LineLocator& locator, const char* data, uint64_t dataBase, const EngineMatch& m) {
+        if (!options.lines || hit.locations.size() >= options.maxLocations) return;
+        uint64_t absStart = dataBase + m.start;
+        locator.Advance(data, dataBase, absStart);
+        ScanLocation loc;
+        loc.line = locator.line;
+        loc.column = absStart - locator.lineStart + 1;
+        loc.text.assign(data + m.start, std::min<size_t>(m.length, 80));
+        for (char& c : loc.text) if (c == '\n' || c == '\r' || c == '\t') c = ' ';
+        hit.locations.push_back(loc);
+    }
+
+    std::string ShownPath(const std::filesystem::path& filePath) const {
+        return (filePath == root) ? filePath.filename().string() : filePath.lexically_relative(root).string();
+    }
+
+    // UNREADABLE: Permissions, a file removed since the walk, an I/O or allocation failure. The file
+    // leaves the queued totals, so progress still reaches them, and is reported as a warning hit
+    // that belongs to no pattern (pattern -1).
+    void SkipUnreadable(const QueuedFile& file, const std::string& reason) {
+        filesUnreadable++;
+        filesQueued--;
+        bytesQueued -= file.size;
+        ScanHit hit;
+        hit.path = ShownPath(file.path);
+        hit.pattern = -1;
+        hit.warning = "unreadable (" + reason + ")";
+        results.Push(std::move(hit));
+    }
+
+    // An explicitly named file is always scanned; inside a directory walk binaries are dropped
+    bool SkipBinary(const std::filesystem::path& filePath, const char* data, size_t sniffed, uintmax_t fileSize) {
+        if (!options.skipBinary || filePath == root || !LooksBinary(data, sniffed)) return false;
+        filesBinary++;
+        filesQueued--;
+        bytesQueued -= fileSize;
+        return true;
+    }
+
+    // STREAM MODE: Fixed-size chunks, the last 'overlap' bytes are carried into the next
+    // chunk. A match is only accepted when it starts before the carried tail (or at EOF),
+    // so matches crossing a boundary are counted exactly once as long as they fit the overlap.
+    // A match past the boundary is not trusted as the next start: an earlier one may only be
+    // visible with more bytes ('xyy|y' sees 'y' before 'xyy' is complete), so the next chunk
+    // searches again from the boundary.
+    // Each pattern of a set keeps its own resume point; the carry starts at the earliest one.
+    // 'start' continues an earlier scan from its checkpoints (the file only grew); 'record'
+    // receives the checkpoints of this one. Returns false when the file was skipped (binary or unreadable).
+    bool ScanStream(const QueuedFile& file, EngineRow& row, std::vector<char>& buffer, std::vector<char>& candidates,
+                    std::vector<ScanHit>& hits, const ScanCacheEntry* start = nullptr, ScanCacheEntry* record = nullptr) {
+        const std::filesystem::path& filePath = file.path;
+        CompressionType compression = COMPRESSION_NONE;
+        std::unique_ptr<ByteReader> reader = OpenByteReader(filePath, compression);
+        if (!reader) { SkipUnreadable(file, "cannot open"); return false; }
+        if (compression != COMPRESSION_NONE) archivesScanned++;
+        buffer.resize(options.chunkSize);
+        size_t patternCount = row.size();
+        std::vector<LineLocator> locators(patternCount);
+        std::vector<size_t> from(patternCount, 0);   // search start; >0 keeps one byte of look-behind context
+        std::vector<size_t> resume(patternCount, 0);
+        uint64_t base = 0; // absolute file offset of buffer[0]
+        size_t filled = 0; // valid bytes in buffer
+        if (start) {
+            uint64_t earliest = EarliestResume(*start);
+            base = earliest > 0 ? earliest - 1 : 0;
+            if (!reader->Seek(base)) return ScanStream(file, row, buffer, candidates, hits, nullptr, record);
+            bytesQueued -= base;
+            bytesReused += base;
+            for (size_t p = 0; p < patternCount; p++) {
+                const ScanCheckpoint& cp = start->patterns[p];
+                hits[p].count = cp.heldCount;
+                hits[p].locations.assign(cp.locations.begin(), cp.locations.begin() + std::min<size_t>(cp.heldLocations, cp.locations.size()));
+                from[p] = (size_t)(cp.resume - base);
+                locators[p].line = cp.line;
+                locators[p].lineStart = cp.lineStart;
+                locators[p].offset = cp.resume;
+            }
+        }
+        if (record) {
+            record->compressed = compression != COMPRESSION_NONE;
+            record->patterns.assign(patternCount, ScanCheckpoint());
+        }
+        uint64_t consumed = reader->Consumed();
+        bool eof = false;
+        while (!eof && !cancelRequested) {
+            size_t want = buffer.size() - filled;
+            size_t got = reader->ReadFull(buffer.data() + filled, want);
+            if (base == 0 && filled == 0) {
+                std::error_code ec;
+                uintmax_t fileSize = std::filesystem::file_size(filePath, ec);
+                if (SkipBinary(filePath, buffer.data(), got, ec ? 0 : fileSize)) return false;
+            }
+            bytesScanned += reader->Consumed() - consumed; // bytes on disk, the unit of bytesQueued
+            consumed = reader->Consumed();
+            if (compression != COMPRESSION_NONE) bytesInflated += got;
+            filled += got;
+            eof = got < want;
+            if (eof && !reader->error.empty()) {
+                // A truncated or corrupt archive invalidates every pattern's partial result
+                for (size_t p = 0; p < patternCount; p++) { hits[p].warning = reader->error; hits[p].count = 0; hits[p].locations.clear(); }
+            }
+
+            size_t boundary = eof ? filled : filled - options.overlap;
+            bool track = eof && record;
+            if (patternCount > 1) literalSet.Scan(buffer.data(), filled, candidates);
+            for (size_t p = 0; p < patternCount; p++) {
+                ScanHit& hit = hits[p];
+                resume[p] = std::max(boundary, from[p]);
+                // Checkpoint: the carry this chunk would have made had the file gone on
+                size_t hold = std::max(from[p], filled > options.overlap ? filled - options.overlap : 0);
+                LineLocator holdLocator = locators[p];
+                uint64_t heldCount = hit.count;
+                size_t heldLocations = hit.locations.size(), heldEnd = from[p];
+                if (hit.warning.empty() && candidates[p]) {
+                    try {
+                        resume[p] = SearchChunkWindow(prefilters[p], *row[p], buffer.data(), filled, from[p], boundary, eof, [&](const EngineMatch& m) {
+                            hit.count++;
+                            RecordLocation(hit, locators[p], buffer.data(), base, m);
+                            if (track && m.start < hold) { heldCount = hit.count; heldLocations = hit.locations.size(); heldEnd = m.start + m.length; }
+                        });
+                    } catch (const MatchBudgetExceeded& e) {
+                        hit.warning = FormatMatchAbort(e, (size_t)base); // file offset, not chunk offset
+                        continue;
+                    }
+                }
+                if (track) {
+                    ScanCheckpoint& cp = record->patterns[p];
+                    cp.count = hit.count;
+                    cp.heldCount = heldCount;
+                    cp.resume = base + std::max(heldEnd, hold);
+                    cp.heldLocations = (uint32_t)heldLocations;
+                    cp.locations = hit.locations;
+                    if (options.lines && heldLocations < options.maxLocations) {
+                        holdLocator.Advance(buffer.data(), base, cp.resume);
+                        cp.line = holdLocator.line;
+                        cp.lineStart = holdLocator.lineStart;
+                    }
+                }
+            }
+            if (eof) break;
+
+            // Carry [keepFrom, filled) to the front: one context byte plus the unfinished tail
+            size_t keepFrom = filled;
+            for (size_t p = 0; p < patternCount; p++) keepFrom = std::min(keepFrom, resume[p] > 0 ? resume[p] - 1 : 0);
+            for (size_t p = 0; p < patternCount; p++) {
+                if (options.lines && hits[p].locations.size() < options.maxLocations) locators[p].Advance(buffer.data(), base, base + keepFrom);
+                from[p] = resume[p] - keepFrom;
+            }
+            std::memmove(buffer.data(), buffer.data() + keepFrom, filled - keepFrom);
+            filled -= keepFrom;
+            base += keepFrom;
+        }
+        return true;
+    }
+
+    static uint64_t EarliestResume(const ScanCacheEntry& entry) {
+        uint64_t earliest = entry.id.size;
+        for (const auto& cp : entry.patterns) earliest = std::min(earliest, cp.resume);
+        return earliest;
+    }
+
+    // Same inode, larger, and the bytes before the checkpoints are still the ones we matched
+    bool CanResume(const std::filesystem::path& filePath, const ScanCacheEntry& entry, const FileIdentity& id) {
+        if (entry.compressed || entry.id.inode == 0 || entry.id.inode != id.inode || id.size <= entry.id.size) return false;
+        uint64_t earliest = EarliestResume(entry);
+        uint32_t hash = 0;
+        return earliest >= entry.tailFrom && HashFileRange(filePath, entry.tailFrom, (size_t)(earliest - entry.tailFrom), hash) && hash == entry.tailHash;
+    }
+
+    // SCAN CACHE: Unchanged files are answered without being opened, files that only grew are
+    // matched from their checkpoints on, anything else is scanned from the start and recorded.
+    bool ScanWithCache(const QueuedFile& file, EngineRow& row, std::vector<char>& buffer, std::vector<char>& candidates, std::vector<ScanHit>& hits) {
+        const std::filesystem::path& filePath = file.path;
+        FileIdentity id;
+        if (!StatFileIdentity(filePath, id)) return ScanStream(file, row, buffer, candidates, hits);
+        std::string key = ScanCache::Key(filePath, setHash);
+        ScanCacheEntry cached;
+        bool have = cache.Lookup(key, cached) && cached.patterns.size() == hits.size();
+        if (have && cached.id.size == id.size && cached.id.mtime == id.mtime && cached.id.inode == id.inode) {
+            for (size_t p = 0; p < hits.size(); p++) {
+                hits[p].count = cached.patterns[p].count;
+                hits[p].locations = cached.patterns[p].locations;
+            }
+            filesCached++;
+            bytesReused += id.size;
+            bytesQueued -= id.size;
+            return true;
+        }
+        bool resumed = have && CanResume(filePath, cached, id);
+        if (resumed) filesResumed++;
+        ScanCacheEntry entry;
+        if (!ScanStream(file, row, buffer, candidates, hits, resumed ? &cached : nullptr, &entry)) return false;
+        if (cancelRequested) return true;
+        for (const auto& hit : hits) if (!hit.warning.empty()) return true; // aborted files are not cached
+        entry.id = id;
+        if (!entry.compressed) {
+            uint64_t earliest = EarliestResume(entry);
+            entry.tailFrom = earliest > ScanCache::TAIL_BYTES ? earliest - ScanCache::TAIL_BYTES : 0;
+            if (!HashFileRange(filePath, entry.tailFrom, (size_t)(earliest - entry.tailFrom), entry.tailHash)) entry.id.inode = 0;
+        }
+        cache.Store(key, std::move(entry));
+        return true;
+    }
+
+    void Work(unsigned self) {
+        EngineRow& row = engines[self];
+        size_t patternCount = row.size();
+        QueuedFile file;
+        const std::filesystem::path& filePath = file.path;
+        std::vector<char> buffer;
+        std::vector<char> candidates(patternCount, 1);
+        FileView view;
+        while (NextFile(self, file)) {
+            ProfileScope scope("scan file", &workerBusyUs[self]);
+            if (scope.Tracing()) scope.detail = filePath.string();
+            std::vector<ScanHit> hits(patternCount);
+            try {
+                bool streamed = options.stream || useCache; // checkpoints are stream offsets
+                if (!streamed) {
+                    if (!view.Open(filePath, buffer)) { SkipUnreadable(file, "cannot open"); continue; }
+                    // Archives cannot be matched in place: they go through the decompressing stream reader
+                    CompressionType compression = DetectCompression(view.Data(), view.Size());
+                    if (compression != COMPRESSION_NONE && CompressionSupported(compression)) { view.Close(); streamed = true; }
+                }
+                if (streamed) {
+                    bool scanned = useCache ? ScanWithCache(file, row, buffer, candidates, hits) : ScanStream(file, row, buffer, candidates, hits);
+                    if (!scanned) continue;
+                } else {
+                    const char* data = view.Data();
+                    size_t size = view.Size();
+                    if (SkipBinary(filePath, data, size, size)) { view.Close(); continue; }
+                    if (patternCount > 1) literalSet.Scan(data, size, candidates);
+                    for (size_t p = 0; p < patternCount; p++) {
+                        if (!candidates[p]) continue;
+                        ScanHit& hit = hits[p];
+                        try {
+                            if (options.lines) {
+                                LineLocator locator;
+                                prefilters[p].ForEach(*row[p], data, data + size, 0, [&](const EngineMatch& m) {
+                                    hit.count++;
+                                    RecordLocation(hit, locator, data, 0, m);
+                                    return true;
+                                });
+                            } else {
+                                hit.count = prefilters[p].Count(*row[p], data, data + size);
+                            }
+                        } catch (const MatchBudgetExceeded& e) {
+                            // Report and move on: one pathological file must not stall the worker
+                            hit.warning = FormatMatchAbort(e);
+                        }
+                    }
+                    bytesScanned += size;
+                    view.Close();
+                }
+            } catch (const std::bad_alloc&) {
+                view.Close();
+                SkipUnreadable(file, "out of memory");
+                continue;
+            } catch (const std::system_error& e) { // filesystem_error, ios_base::failure
+                view.Close();
+                SkipUnreadable(file, e.what());
+                continue;
+            }
+
+            std::string shown = ShownPath(filePath);
+            bool aborted = false;
+            for (size_t p = 0; p < patternCount; p++) {
+                ScanHit& hit = hits[p];
+                if (!hit.warning.empty()) { aborted = true; hit.count = 0; hit.locations.clear(); }
+                else if (hit.count == 0) continue;
+                hit.path = shown;
+                hit.pattern = (int)p;
+                totalMatches += hit.count;
+                patternMatches[p] += hit.count;
+                results.Push(std::move(hit));
+            }
+            if (aborted) filesAborted++;
+            filesScanned++;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------------
+// Playground Buffer
+// ----------------------------------------------------------------------------------
+
+// PIECE TABLE: The playground text is a list of spans over a read-only original (the assigned
+// text or a memory-mapped sample file) and append-only add blocks. The playground only edits at
+// the end, so typing extends the last span and backspace shortens it. Written bytes are never
+// overwritten and the storage is shared, so a copy of the table is a stable snapshot for a worker.
+class PieceTable {
+public:
+    struct Span { const char* data; size_t length; };
+    static const size_t BLOCK_SIZE = 64 * 1024;
+    static const size_t EDIT_HISTORY = 256;
+
+    PieceTable() { Assign(""); }
+    explicit PieceTable(const std::string& text) { Assign(text); }
+
+    void Assign(const std::string& text) {
+        storage = std::make_shared<Storage>();
+        storage->original = text;
+        ResetSpans(storage->original.data(), storage->original.size());
+        source.clear();
+    }
+
+    bool Load(const std::filesystem::path& path, std::string& error) {
+        auto loaded = std::make_shared<Storage>();
+        if (!loaded->view.Open(path, loaded->smallFile)) { error = "Could not open " + path.string(); return false; }
+        storage = loaded;
+        ResetSpans(storage->view.Data(), storage->view.Size());
+        source = path.string();
+        return true;
+    }
+
+    void Append(const char* s, size_t n) {
+        if (n == 0) return;
+        size_t floorPos = total;
+        auto& blocks = storage->blocks;
+        while (n > 0) {
+            if (blocks.empty() || blocks.back().size() == blocks.back().capacity()) {
+                blocks.emplace_back();
+                blocks.back().reserve(std::max(BLOCK_SIZE, n)); // reserved once: data() never moves
+            }
+            std::vector<char>& block = blocks.back();
+            size_t take = std::min(n, block.capacity() - block.size());
+            const char* dst = block.data() + block.size();
+            block.insert(block.end(), s, s + take);
+            if (!spans.empty() && spans.back().data + spans.back().length == dst) spans.back().length += take;
+            else { offsets.push_back(total); spans.push_back({ dst, take }); }
+            total += take;
+            s += take; n -= take;
+        }
+        RecordEdit(floorPos);
+    }
+    PieceTable& operator+=(const std::string& s) { Append(s.data(), s.size()); return *this; }
+    PieceTable& operator+=(char c) { Append(&c, 1); return *this; }
+
+    // Drops bytes from the end; the add blocks keep them, so snapshots stay valid
+    void Truncate(size_t newSize) {
+        if (newSize >= total) return;
+        while (!spans.empty() && offsets.back() >= newSize) { spans.pop_back(); offsets.pop_back(); }
+        if (!spans.empty()) spans.back().length = newSize - offsets.back();
+        total = newSize;
+        RecordEdit(newSize);
+    }
+    void pop_back() { if (total) Truncate(total - 1); }
+
+    size_t size() const { return total; }
+    size_t length() const { return total; }
+    bool empty() const { return total == 0; }
+    const std::string& Source() const { return source; }
+
+    char operator[](size_t i) const {
+        size_t k = SpanAt(i);
+        return spans[k].data[i - offsets[k]];
+    }
+
+    // fn(data, length, offset) for the pieces of [from, to)
+    template <typename Fn>
+    void ForEachSpan(size_t from, size_t to, Fn fn) const {
+        if (to > total) to = total;
+        if (from >= to) return;
+        for (size_t k = SpanAt(from); k < spans.size() && offsets[k] < to; k++) {
+            size_t b = std::max(from, offsets[k]);
+            size_t e = std::min(to, offsets[k] + spans[k].length);
+            fn(spans[k].data + (b - offsets[k]), e - b, b);
+        }
+    }
+
+    // Pointer to [pos, pos + len): in place when one span holds it, otherwise copied into 'scratch'
+    const char* Contiguous(size_t pos, size_t len, std::string& scratch) const {
+        if (len == 0 || pos >= total) return "";
+        if (pos + len > total) len = total - pos;
+        size_t k = SpanAt(pos);
+        if (pos + len <= offsets[k] + spans[k].length) return spans[k].data + (pos - offsets[k]);
+        scratch.clear();
+        scratch.reserve(len);
+        ForEachSpan(pos, pos + len, [&](const char* d, size_t n, size_t) { scratch.append(d, n); });
+        return scratch.data();
+    }
+
+    std::string substr(size_t pos, size_t len) const {
+        std::string out;
+        ForEachSpan(pos, pos + std::min(len, total - std::min(pos, total)), [&](const char* d, size_t n, size_t) { out.append(d, n); });
+        return out;
+    }
+
+    // Edit serial numbers let caches resume: every byte below StableSince(serial) is unchanged since then
+    uint64_t Serial() const { return serial; }
+    size_t StableSince(uint64_t since) const {
+        if (since == serial) return total;
+        if (edits.empty() || edits.front().first > since + 1) return 0; // older than the kept history
+        size_t stable = total;
+        for (const auto& e : edits) if (e.first > since) stable = std::min(stable, e.second);
+        return stable;
+    }
+
+private:
+    struct Storage {
+        FileView view;
+        std::vector<char> smallFile;
+        std::string original;
+        std::deque<std::vector<char>> blocks;
+    };
+    std::shared_ptr<Storage> storage;
+    std::vector<Span> spans;
+    std::vector<size_t> offsets; // document offset of each span
+    size_t total = 0;
+    uint64_t serial = 0;
+    std::deque<std::pair<uint64_t, size_t>> edits; // (serial, lowest offset touched)
+    std::string source;
+
+    void ResetSpans(const char* data, size_t n) {
+        spans.clear(); offsets.clear();
+        if (n) { spans.push_back({ data, n }); offsets.push_back(0); }
+        total = n;
+        RecordEdit(0);
+    }
+
+    void RecordEdit(size_t floorPos) {
+        edits.push_back({ ++serial, floorPos });
+        if (edits.size() > EDIT_HISTORY) edits.pop_front();
+    }
+
+    size_t SpanAt(size_t pos) const {
+        return (size_t)(std::upper_bound(offsets.begin(), offsets.end(), pos) - offsets.begin()) - 1;
+    }
+};
+
+// BACKGROUND MATCH COUNT: Counts the whole document on a worker thread in chunks (same overlap
+// rule as scan --stream) and keeps a checkpoint per chunk, so an edit only recounts from the
+// last checkpoint that lies more than one overlap before it.
+class DocumentMatchCounter {
+public:
+    static const size_t CHUNK = 1 << 20;
+    static const size_t OVERLAP = 64 * 1024;
+
+    ~DocumentMatchCounter() { Stop(); }
+
+    // 'stable' = bytes at the front of doc unchanged since the previous Start with the same pattern
+    bool Start(const PieceTable& doc, const std::string& pattern, EngineType engineType, size_t stable, std::string& error) {
+        Stop();
+        if (pattern != countedPattern || engineType != countedEngine) {
+            checkpoints.clear();
+            engine = CompileEngine(engineType, pattern, error);
+            if (!engine) { countedPattern.clear(); return false; }
+            prefilter.Build(pattern);
+            countedPattern = pattern;
+            countedEngine = engineType;
+        }
+        while (!checkpoints.empty() && checkpoints.back().resume + OVERLAP > stable) checkpoints.pop_back();
+        snapshot = doc;
+        Checkpoint from = checkpoints.empty() ? Checkpoint{ 0, 0 } : checkpoints.back();
+        count = from.countBefore;
+        position = from.resume;
+        cancelRequested = false;
+        finished = false;
+        aborted = false;
+        worker = std::thread([this, from]() { Run(from); });
+        return true;
+    }
+
+    void Stop() {
+        cancelRequested = true;
+        if (worker.joinable()) worker.join();
+    }
+
+    bool Finished() const { return finished; }
+    bool Aborted() const { return aborted; }
+    const std::string& AbortMessage() const { return abortMessage; } // valid once Aborted()
+    uint64_t Count() const { return count; }
+    double Progress() const { return snapshot.size() ? (double)position / snapshot.size() : 1.0; }
+
+private:
+    struct Checkpoint { size_t resume; uint64_t countBefore; };
+    std::vector<Checkpoint> checkpoints; // written by the worker, read only after join
+    std::unique_ptr<RegexEngine> engine;
+    LiteralPrefilter prefilter;
+    std::string countedPattern;
+    EngineType countedEngine = ENGINE_AUTO;
+    PieceTable snapshot;
+    std::thread worker;
+    std::atomic<bool> cancelRequested{ false };
+    std::atomic<bool> finished{ false };
+    std::atomic<bool> aborted{ false };
+    std::string abortMessage; // written before 'aborted' is set
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<size_t> position{ 0 };
+
+    void Run(Checkpoint from) {
+        std::string scratch;
+        size_t total = snapshot.size();
+        size_t pos = from.resume;
+        uint64_t n = from.countBefore;
+        try {
+            while (pos < total && !cancelRequested) {
+                size_t context = pos > 0 ? 1 : 0; // one byte of look-behind for ^ and \b
+                size_t winStart = pos - context;
+                size_t winEnd = std::min(total, pos + CHUNK + OVERLAP);
+                bool last = (winEnd == total);
+                const char* data = snapshot.Contiguous(winStart, winEnd - winStart, scratch);
+                size_t boundary = last ? winEnd - winStart : pos + CHUNK - winStart;
+                size_t resume = 0;
+                try {
+                    resume = SearchChunkWindow(prefilter, *engine, data, winEnd - winStart, context, boundary, last, [&](const EngineMatch&) { n++; });
+                } catch (const MatchBudgetExceeded& e) {
+                    abortMessage = FormatMatchAbort(e, winStart);
+                    aborted = true;
+                    break;
+                }
+                count = n;
+                if (last) { pos = total; break; }
+                pos = winStart + resume;
+                checkpoints.push_back({ pos, n });
+                position = pos;
+            }
+        } catch (...) {}
+        position = pos;
+        if (!cancelRequested) finished = true;
+        if (aborted) checkpoints.clear(); // never resume past an aborted chunk
+    }
+};
+
+// ----------------------------------------------------------------------------------
+// Benchmark
+// ----------------------------------------------------------------------------------
+
+struct BenchOptions {
+    std::string pattern;
+    int runs = 5;
+};
+
+struct BenchResult {
+    std::string engine;      // backend name, "+prefilter" when the scanner's literal skip was used
+    std::string error;       // compile error or match budget abort; the timings are empty then
+    double compileMs = 0;    // fastest of 'runs' compiles
+    double mbPerSec = 0;     // median run
+    double matchesPerSec = 0;
+    uint64_t matches = 0;    // per run
+    double p50Us = 0;        // per-match latency: time from the previous match to this one
+    double p99Us = 0;
+};
+
+const size_t BENCH_MAX_SAMPLES = 1 << 20; // latency samples kept per backend
+
+// Times every backend over one input on a worker thread. Throughput runs only count, the
+// latency run timestamps each match separately so the clock reads do not skew MB/s.
+class BenchJob {
+public:
+    std::atomic<bool> finished{ false };
+    std::atomic<int> progress{ 0 }; // finished variants
+    std::vector<BenchResult> results; // read only once 'finished'
+    std::string source;
+    size_t inputSize = 0;
+
+    ~BenchJob() { Cancel(); Wait(); }
+
+    bool OpenFile(const std::filesystem::path& path, std::string& error) {
+        if (!view.Open(path, fileBuffer)) { error = "Cannot read " + path.string(); return false; }
+        data = view.Data();
+        inputSize = view.Size();
+        source = path.string();
+        return true;
+    }
+
+    void UseText(const PieceTable& text) {
+        sample = text.substr(0, text.size());
+        data = sample.data();
+        inputSize = sample.size();
+        source = "playground sample";
+    }
+
+    void Start(const BenchOptions& opts) {
+        options = opts;
+        if (options.runs < 1) options.runs = 1;
+        worker = std::thread([this]() { Run(); finished = true; });
+    }
+
+    int Variants() const { return variantCount; }
+    void Cancel() { cancelRequested = true; }
+    bool Cancelled() const { return cancelRequested; }
+    void Wait() { if (worker.joinable()) worker.join(); }
+
+private:
+    BenchOptions options;
+    FileView view;
+    std::vector<char> fileBuffer;
+    std::string sample;
+    const char* data = "";
+    std::thread worker;
+    std::atomic<bool> cancelRequested{ false };
+    std::atomic<int> variantCount{ 0 };
+
+    static double Millis(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    void Run() {
+        LiteralPrefilter prefilter;
+        prefilter.Build(options.pattern);
+        const EngineType types[] = { ENGINE_STD, ENGINE_DFA };
+        variantCount = prefilter.Active() ? 4 : 2;
+        for (EngineType type : types) {
+            for (int withPrefilter = 0; withPrefilter <= (prefilter.Active() ? 1 : 0); withPrefilter++) {
+                if (cancelRequested) return;
+                results.push_back(Measure(type, withPrefilter ? &prefilter : nullptr));
+                progress++;
+            }
+        }
+    }
+
+    BenchResult Measure(EngineType type, const LiteralPrefilter* prefilter) {
+        BenchResult r;
+        r.engine = EngineTypeName(type);
+        if (prefilter) r.engine += "+prefilter";
+
+        std::unique_ptr<RegexEngine> engine;
+        r.compileMs = -1;
+        for (int k = 0; k < options.runs; k++) {
+            auto t0 = std::chrono::steady_clock::now();
+            engine = CompileEngine(type, options.pattern, r.error);
+            double ms = Millis(std::chrono::steady_clock::now() - t0);
+            if (!engine) { r.compileMs = 0; return r; }
+            if (r.compileMs < 0 || ms < r.compileMs) r.compileMs = ms;
+        }
+        const char* end = data + inputSize;
+        auto forEach = [&](const std::function<bool(const EngineMatch&)>& fn) {
+            if (prefilter) prefilter->ForEach(*engine, data, end, 0, fn);
+            else engine->ForEach(data, end, 0, false, fn);
+        };
+
+        try {
+            std::vector<double> runMs;
+            for (int k = 0; k < options.runs && !cancelRequested; k++) {
+                uint64_t n = 0;
+                auto t0 = std::chrono::steady_clock::now();
+                forEach([&](const EngineMatch&) { n++; return !cancelRequested; });
+                runMs.push_back(Millis(std::chrono::steady_clock::now() - t0));
+                r.matches = n;
+            }
+            if (cancelRequested) { r.error = "cancelled"; return r; }
+            std::sort(runMs.begin(), runMs.end());
+            double seconds = std::max(1e-9, runMs[runMs.size() / 2] / 1000.0);
+            r.mbPerSec = inputSize / (1024.0 * 1024.0) / seconds;
+            r.matchesPerSec = r.matches / seconds;
+
+            std::vector<double> latencyUs;
+            latencyUs.reserve((size_t)std::min<uint64_t>(r.matches, BENCH_MAX_SAMPLES));
+            auto last = std::chrono::steady_clock::now();
+            forEach([&](const EngineMatch&) {
+                auto now = std::chrono::steady_clock::now();
+                latencyUs.push_back(Millis(now - last) * 1000.0);
+                last = now;
+                return latencyUs.size() < BENCH_MAX_SAMPLES && !cancelRequested;
+            });
+            if (!latencyUs.empty()) {
+                auto at = [&](double q) {
+                    auto nth = latencyUs.begin() + (size_t)(q * (latencyUs.size() - 1));
+                    std::nth_element(latencyUs.begin(), nth, latencyUs.end());
+                    return *nth;
+                };
+                r.p50Us = at(0.50);
+                r.p99Us = at(0.99);
+            }
+        } catch (const MatchBudgetExceeded& e) {
+            r.error = FormatMatchAbort(e);
+        } catch (const std::exception& e) {
+            r.error = e.what();
+        }
+        return r;
+    }
+};
+
+std::string FormatBenchResult(const BenchResult& r);
+
+std::string CsvField(const std::string& v);
+
+std::string JsonString(const std::string& v);
+
+bool WriteBenchCsv(const std::string& path, const BenchJob& job, const std::string& pattern);
+
+bool WriteBenchJson(const std::string& path, const BenchJob& job, const std::string& pattern);
+
+// CHROME TRACE: Complete ("X") events plus thread names, loadable in chrome://tracing or Perfetto
+bool WriteChromeTrace(const std::string& path, const std::vector<TraceEvent>& events);
@@ -0,0 +1,349 @@
+/**
+ * REGEX STUDIO CORE TESTS
+ * Behaviour checks for regexstudio_core, run by ctest. Each case logs "[FAIL] ..." lines and
+ * the process exits non-zero when any check failed. './core_tests <name>' runs one case.
+ */
+
+#include "regexstudio_core.h"
+
+// ----------------------------------------------------------------------------------
+// Harness
+// ----------------------------------------------------------------------------------
+
+int failures = 0;
+
+void Check(bool ok, const std::string& what) {
+    if (ok) return;
+    failures++;
+    fprintf(stderr, "[FAIL] %s\n", what.c_str());
+}
+
+// Deterministic generator, so a failure names a case that reproduces
+struct TestRng {
+    uint64_t state;
+    explicit TestRng(uint64_t seed) : state(seed * 2654435761ull + 1) {}
+    uint32_t Next(uint32_t n) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (uint32_t)(state >> 33) % n;
+    }
+    std::string Text(size_t size, const char* alphabet) {
+        std::string s;
+        size_t k = strlen(alphabet);
+        for (size_t i = 0; i < size; i++) s += alphabet[Next((uint32_t)k)];
+        return s;
+    }
+};
+
+// A scratch directory under the system temp path, removed with everything in it
+class TempDir {
+public:
+    TempDir() {
+        std::string unique = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+        path = std::filesystem::temp_directory_path() / ("regexstudio_test_" + unique);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() { std::error_code ec; std::filesystem::remove_all(path, ec); }
+
+    std::filesystem::path Write(const std::string& name, const std::string& data) const {
+        std::filesystem::path file = path / name;
+        std::ofstream(file, std::ios::binary).write(data.data(), (std::streamsize)data.size());
+        return file;
+    }
+
+    std::filesystem::path path;
+};
+
+uint64_t ScanCount(const std::filesystem::path& target, const std::string& pattern, EngineType engine,
+                   bool stream, size_t chunk = 0, size_t overlap = 0) {
+    ScanOptions opts;
+    opts.pattern = pattern;
+    opts.engine = engine;
+    opts.threads = 1;
+    opts.stream = stream;
+    if (stream) { opts.chunkSize = chunk; opts.overlap = overlap; }
+    FileScanner scanner;
+    std::string error;
+    if (!scanner.Start(target, opts, error)) { Check(false, "scan of '" + pattern + "' did not start: " + error); return 0; }
+    scanner.Wait();
+    return scanner.totalMatches;
+}
+
+// ----------------------------------------------------------------------------------
+// Cases
+// ----------------------------------------------------------------------------------
+
+// STREAM CHUNKS: Chunked reads must count what a whole-file search counts, whatever the
+// chunk/overlap split, for matches no longer than the overlap
+void TestStreamMatchesWholeFile() {
+    TempDir dir;
+    const char* patterns[] = { "xyy|y", "a|ab|abc", "(x|xy)y", "ab?c", "\\d{1,3}", "y$", "^a", "[ab]c|c" };
+    const size_t splits[][2] = { {9, 4}, {10, 4}, {16, 7}, {64, 8}, {257, 31}, {4096, 64} };
+    TestRng rng(6);
+    for (int t = 0; t < 4; t++) {
+        std::filesystem::path file = dir.Write("text" + std::to_string(t) + ".txt", rng.Text(3000 + t * 777, "abcxy01\n"));
+        for (const char* pattern : patterns) {
+            for (EngineType engine : { ENGINE_STD, ENGINE_DFA }) {
+                uint64_t whole = ScanCount(file, pattern, engine, false);
+                for (const auto& split : splits) {
+                    uint64_t streamed = ScanCount(file, pattern, engine, true, split[0], split[1]);
+                    Check(streamed == whole, std::string("stream '") + pattern + "' " + EngineTypeName(engine) + " chunk " + std::to_string(split[0])
+                          + " overlap " + std::to_string(split[1]) + " on " + file.filename().string() + ": "
+                          + std::to_string(streamed) + " != " + std::to_string(whole));
+                }
+            }
+        }
+    }
+    // The reported case: 'xyy' starts inside the carried tail, 'y' after it is complete first
+    std::filesystem::path file = dir.Write("boundary.txt", "0123456xyy");
+    Check(ScanCount(file, "xyy|y", ENGINE_DFA, true, 9, 4) == 1, "stream 'xyy|y' across a 9 byte chunk");
+}
+
+// UNREADABLE FILES: A queued file that cannot be opened is counted and reported, and leaves the
+// queued totals so progress ends at 100%. Only checked where permissions bite (not as root).
+void TestUnreadableFiles() {
+    TempDir dir;
+    dir.Write("open.txt", "xyy xyy");
+    std::filesystem::path locked = dir.Write("locked.txt", "xyy");
+    std::filesystem::permissions(locked, std::filesystem::perms::none);
+    bool enforced = !std::ifstream(locked, std::ios::binary).is_open();
+    for (bool stream : { false, true }) {
+        ScanOptions opts;
+        opts.pattern = "xyy";
+        opts.threads = 1;
+        opts.stream = stream;
+        FileScanner scanner;
+        std::string error;
+        Check(scanner.Start(dir.path, opts, error), "unreadable scan did not start: " + error);
+        scanner.Wait();
+        std::vector<ScanHit> hits;
+        scanner.results.Drain(hits);
+        std::string mode = stream ? "stream" : "view";
+        Check(scanner.filesScanned + scanner.filesUnreadable == 2, mode + ": scanned + unreadable != 2");
+        Check(scanner.filesQueued == scanner.filesScanned && scanner.bytesQueued == scanner.bytesScanned, mode + ": progress totals off");
+        if (!enforced) continue;
+        bool reported = false;
+        for (const auto& hit : hits) reported |= hit.path == "locked.txt" && hit.pattern == -1 && hit.warning.find("unreadable") == 0;
+        Check(scanner.filesUnreadable == 1 && reported, mode + ": locked.txt not reported as unreadable");
+        Check(scanner.totalMatches == 2, mode + ": matches " + std::to_string(scanner.totalMatches.load()));
+    }
+    std::filesystem::permissions(locked, std::filesystem::perms::owner_all);
+    if (!enforced) printf("[NOTE] unreadable: permissions not enforced for this user, totals checked only\n");
+}
+
+// PLAYGROUND COUNTER: The background count over 1 MB windows equals one whole-buffer count,
+// including a match cut by the end of a window
+void TestDocumentCounterMatchesWholeText() {
+    const size_t windowEnd = DocumentMatchCounter::CHUNK + DocumentMatchCounter::OVERLAP;
+    TestRng rng(13);
+    std::string text = rng.Text(2 * DocumentMatchCounter::CHUNK + 12345, "abcdefgh0123 \n");
+    text.replace(windowEnd - 2, 3, "xyy");
+    for (const char* pattern : { "xyy|y", "a|ab|abc", "\\d{1,3}" }) {
+        std::string error;
+        std::unique_ptr<RegexEngine> engine = CompileEngine(ENGINE_DFA, pattern, error);
+        uint64_t whole = engine->Count(text.data(), text.data() + text.size());
+        DocumentMatchCounter counter;
+        Check(counter.Start(PieceTable(text), pattern, ENGINE_DFA, 0, error), std::string("counter start '") + pattern + "': " + error);
+        while (!counter.Finished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        Check(counter.Finished() && counter.Count() == whole, std::string("counter '") + pattern + "': "
+              + std::to_string(counter.Count()) + " != " + std::to_string(whole));
+    }
+}
+
+// ENGINE PARITY: Generated patterns over a small alphabet, matched by std and by what 'auto'
+// picks; spans and every group must agree. Quantified groups are frequent, so empty loops
+// ('(b?)*') are exercised and must be routed to std.
+std::string GenPattern(TestRng& rng, int depth);
+
+std::string GenAtom(TestRng& rng, int depth) {
+    static const char* atoms[] = { "a", "b", "c", "x", "\\d", "\\w", "\\s", "[ab]", "[^a]", "." };
+    static const char* quantifiers[] = { "", "", "", "*", "+", "?", "{1,2}", "*?", "+?", "{2}" };
+    std::string atom;
+    uint32_t k = rng.Next(10);
+    if (k == 0 && depth < 3) atom = "(" + GenPattern(rng, depth + 1) + ")";
+    else if (k == 1 && depth < 3) atom = "(?:" + GenPattern(rng, depth + 1) + ")";
+    else if (k == 2 && rng.Next(4) == 0) return rng.Next(2) ? "^" : "$";
+    else atom = atoms[rng.Next(10)];
+    return atom + quantifiers[rng.Next(10)];
+}
+
+std::string GenPattern(TestRng& rng, int depth) {
+    std::string s;
+    for (uint32_t i = 0, n = 1 + rng.Next(3); i < n; i++) s += GenAtom(rng, depth);
+    if (rng.Next(8) == 0 && depth < 3) s += "|" + GenPattern(rng, depth + 1);
+    return s;
+}
+
+std::string MatchTrace(RegexEngine& engine, const std::string& text) {
+    std::string out;
+    int n = 0;
+    engine.ForEach(text.data(), text.data() + text.size(), 0, true, [&](const EngineMatch& m) {
+        out += "[" + std::to_string(m.start) + "," + std::to_string(m.length);
+        for (const auto& g : m.groups) out += " " + std::to_string(g.first) + ":" + std::to_string(g.second);
+        out += "]";
+        return ++n < 64;
+    });
+    return out;
+}
+
+void TestEngineParity() {
+    TestRng rng(2);
+    int compared = 0, viaDfa = 0;
+    for (int it = 0; it < 6000; it++) {
+        std::string pattern = GenPattern(rng, 0);
+        std::string text = rng.Text(rng.Next(14), "abcx1 \n");
+        std::string error;
+        StdRegexEngine reference;
+        if (!reference.Compile(pattern, error)) continue;
+        std::unique_ptr<RegexEngine> picked = CompileEngine(ENGINE_AUTO, pattern, error);
+        if (!picked) { Check(false, "auto failed to compile /" + pattern + "/: " + error); continue; }
+        std::string expected;
+        try { expected = MatchTrace(reference, text); } catch (const MatchBudgetExceeded&) { continue; }
+        std::string got = MatchTrace(*picked, text);
+        Check(got == expected, "/" + pattern + "/ (" + picked->Name() + ") on \"" + text + "\": " + got + " != std " + expected);
+        compared++;
+        if (strcmp(picked->Name(), "dfa") == 0) viaDfa++;
+    }
+    Check(viaDfa > compared / 2, "auto picked dfa for only " + std::to_string(viaDfa) + " of " + std::to_string(compared) + " patterns");
+
+    const char* emptyLoops[] = { "(b?)*", "(\\w*)+", "(?:\\d*)+", "x{1,2}(?:\\d*)+(...)*", "(a|)*" };
+    for (const char* pattern : emptyLoops) {
+        std::string error;
+        std::unique_ptr<RegexEngine> picked = CompileEngine(ENGINE_AUTO, pattern, error);
+        Check(picked && strcmp(picked->Name(), "std") == 0, std::string("auto should use std for /") + pattern + "/");
+    }
+    std::string error;
+    std::unique_ptr<RegexEngine> anchors = CompileEngine(ENGINE_DFA, "$^", error);
+    Check(anchors && anchors->Count("", "") == 1, "dfa '$^' on empty input");
+}
+
+// PROJECT CODEC: VREGEX_2 round-trips every field, and any truncation, flipped byte or bad record
+// is rejected with an error instead of being loaded
+std::string EncodeSample(std::vector<ProjectNode>& nodes, std::vector<Connection>& conns, std::vector<std::string>& strings) {
+    TestRng rng(20);
+    strings.clear();
+    for (int i = 0; i < 24; i++) strings.push_back(rng.Text(rng.Next(12), "ab\\d{}()|.\n \x01\xff"));
+    nodes.clear();
+    conns.clear();
+    for (int i = 0; i < 12; i++) {
+        ProjectNode n;
+        n.id = i * 3 + 1;
+        n.type = (NodeType)rng.Next(NODE_OR + 1);
+        n.x = (float)rng.Next(4000) - 2000.5f;
+        n.y = (float)rng.Next(4000) * 0.25f;
+        for (auto& c : n.rgba) c = (unsigned char)rng.Next(256);
+        n.title = strings[i * 2];
+        n.regexValue = strings[i * 2 + 1];
+        nodes.push_back(n);
+        if (i > 0) conns.push_back({ nodes[i - 1].id, n.id });
+    }
+    return EncodeProjectBinary(nodes, conns, 77);
+}
+
+void TestProjectCodec() {
+    std::vector<ProjectNode> nodes;
+    std::vector<Connection> conns;
+    std::vector<std::string> strings;
+    std::string bytes = EncodeSample(nodes, conns, strings);
+
+    std::vector<ProjectNode> outNodes;
+    std::vector<Connection> outConns;
+    int nextId = 0;
+    std::string error;
+    Check(DecodeProjectBinary(bytes.data(), bytes.size(), outNodes, outConns, nextId, error), "codec decode: " + error);
+    Check(nextId == 77 && outNodes.size() == nodes.size() && outConns.size() == conns.size(), "codec counts");
+    for (size_t i = 0; i < outNodes.size() && i < nodes.size(); i++) {
+        const ProjectNode& a = nodes[i];
+        const ProjectNode& b = outNodes[i];
+        Check(a.id == b.id && a.type == b.type && a.x == b.x && a.y == b.y && memcmp(a.rgba, b.rgba, 4) == 0
+              && a.title == b.title && a.regexValue == b.regexValue, "codec node " + std::to_string(i));
+    }
+    for (size_t i = 0; i < outConns.size() && i < conns.size(); i++) {
+        Check(outConns[i].fromNodeId == conns[i].fromNodeId && outConns[i].toNodeId == conns[i].toNodeId, "codec connection " + std::to_string(i));
+    }
+    Check(EncodeProjectBinary(outNodes, outConns, nextId) == bytes, "codec re-encode is byte identical");
+
+    for (size_t size = 0; size < bytes.size(); size++) {
+        Check(!DecodeProjectBinary(bytes.data(), size, outNodes, outConns, nextId, error), "codec accepted a file cut at " + std::to_string(size));
+    }
+    for (size_t at = 0; at < bytes.size(); at++) {
+        if (at < sizeof(VREGEX_MAGIC)) continue; // the magic is ReadProjectFile's format sniff, not the codec's
+        std::string damaged = bytes;
+        damaged[at] ^= 0x20;
+        // nextNodeId sits in the header, outside the checksum; loading raises it past every id anyway
+        Check(!DecodeProjectBinary(damaged.data(), damaged.size(), outNodes, outConns, nextId, error) || (at >= 24 && at < 28),
+              "codec accepted a flipped byte at " + std::to_string(at));
+    }
+
+    // Without the checksum flag the record checks are all that stands between a bad file and the canvas
+    auto unchecked = [&](size_t at, uint32_t value) {
+        std::string damaged = bytes;
+        damaged.replace(8, 4, std::string("\0\0\0\0", 4));
+        std::string v;
+        PutU32(v, value);
+        damaged.replace(at, 4, v);
+        return DecodeProjectBinary(damaged.data(), damaged.size(), outNodes, outConns, nextId, error) ? std::string() : error;
+    };
+    const size_t node1 = VREGEX_HEADER_SIZE + VREGEX_NODE_SIZE;
+    Check(unchecked(node1 + 4, NODE_OR + 1).find("unknown type") != std::string::npos, "codec bad type: " + error);
+    Check(unchecked(node1, (uint32_t)nodes[0].id).find("duplicate node id") != std::string::npos, "codec duplicate id: " + error);
+    Check(unchecked(node1 + 20, 0xFFFFFFF0u).find("out of range") != std::string::npos, "codec string offset: " + error);
+    Check(unchecked(node1 + 24, (uint32_t)bytes.size()).find("out of range") != std::string::npos, "codec string length: " + error);
+}
+
+// REGEX IMPORT: The chain an import builds generates its input again (the README examples and
+// every template), typed tokens carry exactly their palette fragment, and broken patterns fail
+void TestImportRoundTrip() {
+    std::vector<std::string> patterns = {
+        "(a+)+", "(\\w|\\d)+", "\\d+\\d+", "(b?)*", "(\\w*)+", "x{1,2}(?:\\d*)+(...)*",
+        "^\\w+@\\w+\\.\\w+$", "https?://[^\\s/]+(?:/\\S*)?", "(?:\\d{1,3}\\.){3}\\d{1,3}", "(a)(b)\\2\\1\\b",
+        "[]a]|[^]b\\]]+?|\\x41\\u0042\\cA|a{2,}+", "(?=ab)(?!c)(?<=x)(?<!y).\\S\\W\\D\\s*", "a{x}|{|}|a\\{1\\}",
+    };
+    for (int t = 0; t < TPL_COUNT; t++) patterns.push_back(TemplateRegex((TemplateType)t));
+    for (const std::string& pattern : patterns) {
+        std::vector<ImportToken> tokens;
+        std::string error;
+        if (!TokenizeRegex(pattern, tokens, error)) { Check(false, "import /" + pattern + "/: " + error); continue; }
+        std::string generated;
+        size_t covered = 0;
+        for (const auto& tok : tokens) {
+            std::string_view fragment = ImportedFragment(tok, pattern);
+            Check(tok.begin == covered && fragment == std::string_view(pattern).substr(tok.begin, tok.len),
+                  "import /" + pattern + "/ token at " + std::to_string(tok.begin) + " is '" + std::string(fragment) + "'");
+            covered = tok.begin + tok.len;
+            generated += fragment;
+        }
+        Check(generated == pattern, "import /" + pattern + "/ generates /" + generated + "/");
+    }
+    for (const char* broken : { "(a", "a)", "[ab", "ab\\", "(?" }) {
+        std::vector<ImportToken> tokens;
+        std::string error;
+        Check(!TokenizeRegex(broken, tokens, error) && !error.empty(), std::string("import accepted /") + broken + "/");
+    }
+}
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+const TestCase TEST_CASES[] = {
+    { "stream", TestStreamMatchesWholeFile },
+    { "unreadable", TestUnreadableFiles },
+    { "counter", TestDocumentCounterMatchesWholeText },
+    { "parity", TestEngineParity },
+    { "codec", TestProjectCodec },
+    { "import", TestImportRoundTrip },
+};
+
+int main(int argc, char** argv) {
+    int ran = 0;
+    for (const auto& test : TEST_CASES) {
+        if (argc > 1 && strcmp(argv[1], test.name) != 0) continue;
+        int before = failures;
+        test.run();
+        printf("%s %s\n", failures == before ? "[PASS]" : "[FAIL]", test.name);
+        ran++;
+    }
+    if (ran == 0) { fprintf(stderr, "[ERROR] No test named %s\n", argv[1]); return 2; }
+    return failures ? 1 : 0;
+}